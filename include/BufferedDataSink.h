@@ -0,0 +1,27 @@
+#ifndef BUFFEREDDATASINK_H
+#define BUFFEREDDATASINK_H
+
+#include "DataSink.h"
+#include <memory>
+
+// Decorator that collects output and forwards it to the wrapped sink in
+// blocks of up to capacity characters. Anything still buffered is written
+// on Flush or when the sink is destroyed.
+class CBufferedDataSink : public CDataSink{
+    private:
+        std::shared_ptr< CDataSink > DSink;
+        std::vector<char> DBuffer;
+        std::size_t DCapacity;
+    public:
+        static constexpr std::size_t DefaultCapacity = 65536;
+
+        CBufferedDataSink(std::shared_ptr< CDataSink > sink, std::size_t capacity = DefaultCapacity);
+        ~CBufferedDataSink();
+
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *data, std::size_t size) noexcept override;
+        bool Flush() noexcept override;
+};
+
+#endif
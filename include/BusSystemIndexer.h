@@ -2,6 +2,7 @@
 #define BUSSYSTEMINDEXER_H
 #include "BusSystem.h"
 #include <unordered_set>
+#include <vector>
 
 class CBusSystemIndexer{
     private:
@@ -9,6 +10,7 @@ class CBusSystemIndexer{
         std::unique_ptr<SImplementation> DImplementation;
     public:
         using TNodeID = CStreetMap::TNodeID;
+        using TStopID = CBusSystem::TStopID;
         using SStop = CBusSystem::SStop;
         using SRoute = CBusSystem::SRoute;
         CBusSystemIndexer(std::shared_ptr<CBusSystem> bussystem);
@@ -21,6 +23,7 @@ class CBusSystemIndexer{
         std::shared_ptr<SStop> StopByNodeID(TNodeID id) const noexcept;
         bool RoutesByNodeIDs(TNodeID src, TNodeID dest, std::unordered_set<std::shared_ptr<SRoute> > &routes) const noexcept;
         bool RouteBetweenNodeIDs(TNodeID src, TNodeID dest) const noexcept;
+        bool RoutePositionsByStopID(TStopID id, std::vector<std::pair<std::shared_ptr<SRoute>, std::size_t> > &positions) const noexcept;
 };
 
 #endif
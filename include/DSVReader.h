@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "DataSource.h"
 
 class CDSVReader{
@@ -14,8 +16,20 @@ class CDSVReader{
         CDSVReader(std::shared_ptr< CDataSource > src, char delimiter);
         ~CDSVReader();
 
+        static constexpr std::size_t DefaultParallelThreshold = 1 << 20;
+
+        // Once enabled, a borrowed region of at least threshold characters
+        // that holds the rest of the source is split at line feeds and parsed
+        // on threads (0 uses every core, a single core stays serial). Rows
+        // are still returned in order.
+        void EnableParallel(std::size_t threshold = DefaultParallelThreshold, std::size_t threads = 0);
+
         bool End() const;
         bool ReadRow(std::vector<std::string> &row);
+        // Like ReadRow, but the cells point into the reader's buffers and are
+        // only valid until the next read. Only cells with quotes removed are
+        // copied.
+        bool ReadRowView(std::vector<std::string_view> &row);
 };
 
 #endif
@@ -0,0 +1,44 @@
+#ifndef DSVTABLEREADER_H
+#define DSVTABLEREADER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "DSVReader.h"
+
+// Reads a DSV table whose first row holds the column headings. Cells of the
+// current row are looked up by column and parsed without exceptions, every
+// cell that is missing or fails to parse is counted as an error.
+class CDSVTableReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        static constexpr std::size_t InvalidColumn = std::numeric_limits<std::size_t>::max();
+
+        CDSVTableReader(std::shared_ptr< CDSVReader > reader);
+        ~CDSVTableReader();
+
+        const std::vector<std::string> &Headings() const;
+        // Index of the column with the heading, InvalidColumn if there is none
+        std::size_t ColumnIndex(const std::string &heading) const;
+        // For tables found to have no heading row: the first row is handed
+        // back by the next ReadRow as data and the headings are cleared
+        void HeadingsAreData();
+
+        bool End() const;
+        bool ReadRow();
+        std::size_t RowCount() const;
+        std::size_t ErrorCount() const;
+
+        // Cell views are only valid until the next ReadRow
+        bool Cell(std::size_t column, std::string_view &value);
+        bool Unsigned(std::size_t column, uint64_t &value);
+        bool Double(std::size_t column, double &value);
+};
+
+#endif
@@ -2,12 +2,29 @@
 #define DATASINK_H
 
 #include <vector>
+#include <cstddef>
 
 class CDataSink{
     public:
         virtual ~CDataSink(){};
         virtual bool Put(const char &ch) noexcept = 0;
         virtual bool Write(const std::vector<char> &buf) noexcept = 0;
+
+        // Writes size characters starting at data. The default goes through
+        // Put one character at a time.
+        virtual bool Write(const char *data, std::size_t size) noexcept{
+            for(std::size_t Index = 0; Index < size; Index++){
+                if(!Put(data[Index])){
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Pushes anything held back by the sink to its destination
+        virtual bool Flush() noexcept{
+            return true;
+        }
 };
 
 #endif
@@ -2,14 +2,39 @@
 #define DATASOURCE_H
 
 #include <vector>
+#include <cstddef>
 
 class CDataSource{
+    private:
+        char DBorrowedChar;
     public:
         virtual ~CDataSource(){};
         virtual bool End() const noexcept = 0;
         virtual bool Get(char &ch) noexcept = 0;
         virtual bool Peek(char &ch) noexcept = 0;
         virtual bool Read(std::vector<char> &buf, std::size_t count) noexcept = 0;
+
+        // Borrows the next contiguous readable region without copying it.
+        // The region stays valid until the source is next read from (Consume
+        // does not invalidate it) and nothing is consumed until Consume is
+        // called. Returns false at
+        // end. The default lends one character at a time through Peek, so
+        // sources that hold their data in memory should override it.
+        virtual bool Borrow(const char *&data, std::size_t &size) noexcept{
+            if(!Peek(DBorrowedChar)){
+                return false;
+            }
+            data = &DBorrowedChar;
+            size = 1;
+            return true;
+        }
+
+        // Consumes count characters, at most the size of the last Borrow
+        virtual void Consume(std::size_t count) noexcept{
+            char TempCh;
+            while(count-- && Get(TempCh)){
+            }
+        }
 };
 
 #endif
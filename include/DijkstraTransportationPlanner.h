@@ -7,6 +7,7 @@ class CDijkstraTransportationPlanner : public CTransportationPlanner{
     private:
         struct SImplementation;
         std::unique_ptr<SImplementation> DImplementation;
+        CDijkstraTransportationPlanner(std::unique_ptr<SImplementation> implementation);
     public:
         CDijkstraTransportationPlanner(std::shared_ptr<SConfiguration> config);
         ~CDijkstraTransportationPlanner();
@@ -17,6 +18,10 @@ class CDijkstraTransportationPlanner : public CTransportationPlanner{
         double FindShortestPath(TNodeID src, TNodeID dest, std::vector< TNodeID > &path) override;
         double FindFastestPath(TNodeID src, TNodeID dest, std::vector< TTripStep > &path) override;
         bool GetPathDescription(const std::vector< TTripStep > &path, std::vector< std::string > &desc) const override;
+
+        bool WriteSnapshot(const std::string &filename, const std::vector< std::string > &inputs = {}) const;
+        static bool SnapshotMatches(const std::string &filename, std::shared_ptr<SConfiguration> config, const std::vector< std::string > &inputs = {});
+        static std::shared_ptr<CDijkstraTransportationPlanner> LoadSnapshot(const std::string &filename, std::shared_ptr<SConfiguration> config, const std::vector< std::string > &inputs = {});
 };
 
 #endif
@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILEDATASOURCE_H
+#define MAPPEDFILEDATASOURCE_H
+
+#include "DataSource.h"
+#include <string>
+
+// Data source over a read only memory mapping of a regular file. Get, Peek
+// and Read index directly into the mapping instead of going through a stream,
+// and Borrow lends the remainder of the mapping itself.
+class CMappedFileDataSource : public CDataSource{
+    private:
+        const char *DData;
+        std::size_t DSize;
+        std::size_t DIndex;
+        bool DValid;
+    public:
+        CMappedFileDataSource(const std::string &filename);
+        ~CMappedFileDataSource();
+
+        CMappedFileDataSource(const CMappedFileDataSource &) = delete;
+        CMappedFileDataSource &operator=(const CMappedFileDataSource &) = delete;
+
+        // False if the file could not be opened or mapped
+        bool Valid() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Borrow(const char *&data, std::size_t &size) noexcept override;
+        void Consume(std::size_t count) noexcept override;
+};
+
+#endif
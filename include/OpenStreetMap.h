@@ -10,7 +10,9 @@ class COpenStreetMap : public CStreetMap{
         std::unique_ptr<SImplementation> DImplementation;
 
     public:
-        COpenStreetMap(std::shared_ptr<CXMLReader> src);
+        // Loads the map; threads of 0 uses every core, and a single thread
+        // parses and builds the map without a worker pool
+        COpenStreetMap(std::shared_ptr<CXMLReader> src, std::size_t threads = 0);
         ~COpenStreetMap();
 
         std::size_t NodeCount() const noexcept override;
@@ -19,6 +21,7 @@ class COpenStreetMap : public CStreetMap{
         std::shared_ptr<CStreetMap::SNode> NodeByID(TNodeID id) const noexcept override;
         std::shared_ptr<CStreetMap::SWay> WayByIndex(std::size_t index) const noexcept override;
         std::shared_ptr<CStreetMap::SWay> WayByID(TWayID id) const noexcept override;
+        TAttributeID AttributeID(const std::string &str) const noexcept override;
 };
 
 #endif
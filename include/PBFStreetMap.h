@@ -0,0 +1,30 @@
+#ifndef PBFSTREETMAP_H
+#define PBFSTREETMAP_H
+
+#include "DataSource.h"
+#include "StreetMap.h"
+
+// Street map loaded from an OpenStreetMap PBF file: raw or zlib compressed
+// primitive blocks with plain or dense nodes and ways. Relations are skipped.
+// Blocks are decoded on threads (0 uses every core, a single thread decodes
+// in place) and throw std::runtime_error if the file is malformed or needs an
+// unsupported feature.
+class CPBFStreetMap : public CStreetMap{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CPBFStreetMap(std::shared_ptr<CDataSource> src, std::size_t threads = 0);
+        ~CPBFStreetMap();
+
+        std::size_t NodeCount() const noexcept override;
+        std::size_t WayCount() const noexcept override;
+        std::shared_ptr<CStreetMap::SNode> NodeByIndex(std::size_t index) const noexcept override;
+        std::shared_ptr<CStreetMap::SNode> NodeByID(TNodeID id) const noexcept override;
+        std::shared_ptr<CStreetMap::SWay> WayByIndex(std::size_t index) const noexcept override;
+        std::shared_ptr<CStreetMap::SWay> WayByID(TWayID id) const noexcept override;
+        TAttributeID AttributeID(const std::string &str) const noexcept override;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef SEARCHWORKSPACE_H
+#define SEARCHWORKSPACE_H
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+// Scratch state for Dijkstra style searches: per-entry distance, previous
+// entry and a caller defined tag, plus the priority queue storage. Reset()
+// starts a new search in O(1) by advancing a generation counter, entries
+// stamped with an older generation read as unreached. Searches keep one
+// thread_local instance so the arrays are allocated once per thread.
+class CSearchWorkspace{
+    public:
+        static constexpr std::size_t InvalidIndex = std::numeric_limits<std::size_t>::max();
+
+        // Ordered by key, then distance, then index
+        struct SQueueItem{
+            double DKey;
+            double DDistance;
+            std::size_t DIndex;
+
+            bool operator>(const SQueueItem &other) const{
+                if(DKey != other.DKey){
+                    return DKey > other.DKey;
+                }
+                if(DDistance != other.DDistance){
+                    return DDistance > other.DDistance;
+                }
+                return DIndex > other.DIndex;
+            }
+        };
+
+    private:
+        std::vector<double> DDistances;
+        std::vector<std::size_t> DPrevious;
+        std::vector<int> DTags;
+        std::vector<uint32_t> DStamps;
+        uint32_t DGeneration = 0;
+        std::vector<SQueueItem> DQueue;
+
+    public:
+        // Starts a new search over entries [0, size)
+        void Reset(std::size_t size){
+            if(DStamps.size() < size){
+                DDistances.resize(size);
+                DPrevious.resize(size);
+                DTags.resize(size);
+                DStamps.resize(size, 0);
+            }
+            DQueue.clear();
+            if(++DGeneration == 0){
+                std::fill(DStamps.begin(), DStamps.end(), 0);
+                DGeneration = 1;
+            }
+        }
+
+        bool Reached(std::size_t index) const{
+            return DStamps[index] == DGeneration;
+        }
+
+        double Distance(std::size_t index) const{
+            return Reached(index) ? DDistances[index] : std::numeric_limits<double>::max();
+        }
+
+        std::size_t Previous(std::size_t index) const{
+            return Reached(index) ? DPrevious[index] : InvalidIndex;
+        }
+
+        int Tag(std::size_t index) const{
+            return Reached(index) ? DTags[index] : -1;
+        }
+
+        void Update(std::size_t index, double distance, std::size_t previous, int tag = 0){
+            DDistances[index] = distance;
+            DPrevious[index] = previous;
+            DTags[index] = tag;
+            DStamps[index] = DGeneration;
+        }
+
+        bool QueueEmpty() const{
+            return DQueue.empty();
+        }
+
+        void ClearQueue(){
+            DQueue.clear();
+        }
+
+        void Push(double key, double distance, std::size_t index){
+            DQueue.push_back({key, distance, index});
+            std::push_heap(DQueue.begin(), DQueue.end(), std::greater<SQueueItem>());
+        }
+
+        const SQueueItem &Top() const{
+            return DQueue.front();
+        }
+
+        SQueueItem Pop(){
+            std::pop_heap(DQueue.begin(), DQueue.end(), std::greater<SQueueItem>());
+            SQueueItem Item = DQueue.back();
+            DQueue.pop_back();
+            return Item;
+        }
+};
+
+#endif
@@ -8,6 +8,8 @@ class CStandardErrorDataSink : public CDataSink{
     public:
         bool Put(const char &ch) noexcept override;
         bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *data, std::size_t size) noexcept override;
+        bool Flush() noexcept override;
 };
 
 #endif
@@ -12,9 +12,11 @@ class CStreetMap{
         using TNodeID = uint64_t;
         using TWayID = uint64_t;
         using TLocation = std::pair<double, double>;
+        using TAttributeID = uint32_t;
 
         static const TNodeID InvalidNodeID = std::numeric_limits<TNodeID>::max();
         static const TWayID InvalidWayID = std::numeric_limits<TWayID>::max();
+        static const TAttributeID InvalidAttributeID = std::numeric_limits<TAttributeID>::max();
 
         struct SNode{
             virtual ~SNode(){};
@@ -24,6 +26,10 @@ class CStreetMap{
             virtual std::string GetAttributeKey(std::size_t index) const noexcept = 0;
             virtual bool HasAttribute(const std::string &key) const noexcept = 0;
             virtual std::string GetAttribute(const std::string &key) const noexcept = 0;
+            // Returns the value ID for an interned key ID, see AttributeID
+            virtual TAttributeID GetAttributeID(TAttributeID) const noexcept{
+                return InvalidAttributeID;
+            };
         };
 
         struct SWay{
@@ -35,6 +41,10 @@ class CStreetMap{
             virtual std::string GetAttributeKey(std::size_t index) const noexcept = 0;
             virtual bool HasAttribute(const std::string &key) const noexcept = 0;
             virtual std::string GetAttribute(const std::string &key) const noexcept = 0;
+            // Returns the value ID for an interned key ID, see AttributeID
+            virtual TAttributeID GetAttributeID(TAttributeID) const noexcept{
+                return InvalidAttributeID;
+            };
         };
 
         virtual ~CStreetMap(){};
@@ -45,6 +55,12 @@ class CStreetMap{
         virtual std::shared_ptr<SNode> NodeByID(TNodeID id) const noexcept = 0;
         virtual std::shared_ptr<SWay> WayByIndex(std::size_t index) const noexcept = 0;
         virtual std::shared_ptr<SWay> WayByID(TWayID id) const noexcept = 0;
+        // Returns the ID of an interned attribute key or value. Maps that do
+        // not intern attributes, and strings no attribute uses, give
+        // InvalidAttributeID; callers then fall back to the string accessors.
+        virtual TAttributeID AttributeID(const std::string &) const noexcept{
+            return InvalidAttributeID;
+        };
 };
 
 #endif
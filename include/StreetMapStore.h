@@ -0,0 +1,101 @@
+#ifndef STREETMAPSTORE_H
+#define STREETMAPSTORE_H
+
+#include "StreetMap.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Column storage shared by the CStreetMap implementations. Loaders append
+// nodes and ways in file order, then Finish builds the SNode/SWay views that
+// are handed out and the ID indices. Returned views share ownership of the
+// store, so they stay valid after the map that returned them is destroyed.
+struct SStreetMapStore{
+    using TNodeID = CStreetMap::TNodeID;
+    using TWayID = CStreetMap::TWayID;
+    using TLocation = CStreetMap::TLocation;
+    using TAttributeID = CStreetMap::TAttributeID;
+    // Attribute key and value IDs into the string table
+    using TAttribute = std::pair<TAttributeID, TAttributeID>;
+
+    struct SNodeView : public CStreetMap::SNode{
+        const SStreetMapStore *DStore;
+        std::size_t DIndex;
+
+        SNodeView(const SStreetMapStore *store, std::size_t index) : DStore(store), DIndex(index){}
+
+        TNodeID ID() const noexcept override;
+        TLocation Location() const noexcept override;
+        std::size_t AttributeCount() const noexcept override;
+        std::string GetAttributeKey(std::size_t index) const noexcept override;
+        bool HasAttribute(const std::string &key) const noexcept override;
+        std::string GetAttribute(const std::string &key) const noexcept override;
+        TAttributeID GetAttributeID(TAttributeID key) const noexcept override;
+    };
+
+    struct SWayView : public CStreetMap::SWay{
+        const SStreetMapStore *DStore;
+        std::size_t DIndex;
+
+        SWayView(const SStreetMapStore *store, std::size_t index) : DStore(store), DIndex(index){}
+
+        TWayID ID() const noexcept override;
+        std::size_t NodeCount() const noexcept override;
+        TNodeID GetNodeID(std::size_t index) const noexcept override;
+        std::size_t AttributeCount() const noexcept override;
+        std::string GetAttributeKey(std::size_t index) const noexcept override;
+        bool HasAttribute(const std::string &key) const noexcept override;
+        std::string GetAttribute(const std::string &key) const noexcept override;
+        TAttributeID GetAttributeID(TAttributeID key) const noexcept override;
+    };
+
+    // Every distinct tag key and value, stored once
+    std::unordered_map<std::string, TAttributeID> DStringIDs;
+    std::vector<const std::string *> DStrings;
+
+    // Nodes in file order; attributes of node i are
+    // DNodeAttributes[DNodeAttributeOffsets[i], DNodeAttributeOffsets[i + 1])
+    std::vector<TNodeID> DNodeIDs;
+    std::vector<TLocation> DNodeLocations;
+    std::vector<std::size_t> DNodeAttributeOffsets;
+    std::vector<TAttribute> DNodeAttributes;
+
+    // Ways in file order, with node references and attributes pooled the
+    // same way as node attributes
+    std::vector<TWayID> DWayIDs;
+    std::vector<std::size_t> DWayNodeOffsets;
+    std::vector<TNodeID> DWayNodeIDs;
+    std::vector<std::size_t> DWayAttributeOffsets;
+    std::vector<TAttribute> DWayAttributes;
+
+    // (ID, index) pairs sorted by ID, one per distinct ID
+    std::vector<std::pair<TNodeID, std::size_t>> DNodeIndex;
+    std::vector<std::pair<TWayID, std::size_t>> DWayIndex;
+
+    std::vector<SNodeView> DNodeViews;
+    std::vector<SWayView> DWayViews;
+
+    TAttributeID Intern(const std::string &str);
+    // Returns the ID of str, or InvalidAttributeID if it was never interned
+    TAttributeID Lookup(const std::string &str) const noexcept;
+
+    // Start a new node or way; its attributes and node references are
+    // pushed onto the pools until the next one starts
+    void AddNode(TNodeID id, TLocation location);
+    void AddWay(TWayID id);
+
+    // Appends a store built from a later part of the same file, before Finish
+    void Append(const SStreetMapStore &chunk);
+
+    // Closes the offset arrays and builds the views and ID indices, the way
+    // side on its own thread when more than one is available
+    void Finish(std::size_t threads);
+
+    static std::shared_ptr<CStreetMap::SNode> NodeByIndex(const std::shared_ptr<SStreetMapStore> &store, std::size_t index) noexcept;
+    static std::shared_ptr<CStreetMap::SNode> NodeByID(const std::shared_ptr<SStreetMapStore> &store, TNodeID id) noexcept;
+    static std::shared_ptr<CStreetMap::SWay> WayByIndex(const std::shared_ptr<SStreetMapStore> &store, std::size_t index) noexcept;
+    static std::shared_ptr<CStreetMap::SWay> WayByID(const std::shared_ptr<SStreetMapStore> &store, TWayID id) noexcept;
+};
+
+#endif
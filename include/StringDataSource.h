@@ -15,6 +15,8 @@ class CStringDataSource : public CDataSource{
         bool Get(char &ch) noexcept override;
         bool Peek(char &ch) noexcept override;
         bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Borrow(const char *&data, std::size_t &size) noexcept override;
+        void Consume(std::size_t count) noexcept override;
 };
 
 #endif
@@ -9,6 +9,7 @@ class CTransportationPlanner{
     public:
         using TNodeID = CStreetMap::TNodeID;
         enum class ETransportationMode {Walk, Bike, Bus};
+        enum class ESearchAlgorithm {Dijkstra, AStar, ALT, Bidirectional};
         using TTripStep = std::pair<ETransportationMode, TNodeID>;
 
         struct SConfiguration{
@@ -20,6 +21,15 @@ class CTransportationPlanner{
             virtual double DefaultSpeedLimit() const noexcept = 0;
             virtual double BusStopTime() const noexcept = 0;
             virtual int PrecomputeTime() const noexcept = 0;
+            virtual ESearchAlgorithm SearchAlgorithm() const noexcept{
+                return ESearchAlgorithm::Dijkstra;
+            }
+            // Builds the street graphs over way endpoints, intersections and
+            // bus stop nodes only, folding the shape points between them into
+            // single edges. Results are unchanged, searches touch fewer nodes.
+            virtual bool ContractGraphs() const noexcept{
+                return false;
+            }
         };
 
         virtual ~CTransportationPlanner(){};
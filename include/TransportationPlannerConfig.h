@@ -11,6 +11,8 @@ struct STransportationPlannerConfig : public CTransportationPlanner::SConfigurat
     double DDefaultSpeedLimit;
     double DBusStopTime;
     int DPrecomputeTime;
+    CTransportationPlanner::ESearchAlgorithm DSearchAlgorithm;
+    bool DContractGraphs;
 
     STransportationPlannerConfig(   std::shared_ptr<CStreetMap> streetmap, 
                                     std::shared_ptr<CBusSystem> bussystem,
@@ -18,7 +20,9 @@ struct STransportationPlannerConfig : public CTransportationPlanner::SConfigurat
                                     double bikespeed = 8.0,
                                     double speedlimit = 25.0,
                                     double busstoptime = 30.0,
-                                    int precompute = 30){
+                                    int precompute = 30,
+                                    CTransportationPlanner::ESearchAlgorithm algorithm = CTransportationPlanner::ESearchAlgorithm::Dijkstra,
+                                    bool contract = false){
         DStreetMap = streetmap;
         DBusSystem = bussystem;
         DWalkSpeed = walkspeed;
@@ -26,6 +30,8 @@ struct STransportationPlannerConfig : public CTransportationPlanner::SConfigurat
         DDefaultSpeedLimit = speedlimit;
         DBusStopTime = busstoptime;
         DPrecomputeTime = precompute;
+        DSearchAlgorithm = algorithm;
+        DContractGraphs = contract;
 
     }
 
@@ -56,6 +62,14 @@ struct STransportationPlannerConfig : public CTransportationPlanner::SConfigurat
     int PrecomputeTime() const noexcept{
         return DPrecomputeTime;
     }
+
+    CTransportationPlanner::ESearchAlgorithm SearchAlgorithm() const noexcept{
+        return DSearchAlgorithm;
+    }
+
+    bool ContractGraphs() const noexcept{
+        return DContractGraphs;
+    }
 };
 
 #endif
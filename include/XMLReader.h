@@ -2,6 +2,8 @@
 #define XMLREADER_H
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "XMLEntity.h"
 #include "DataSource.h"
 
@@ -11,11 +13,29 @@ class CXMLReader{
         std::unique_ptr<SImplementation> DImplementation;
         
     public:
+        // Receives parser events without building an SXMLEntity. Names and
+        // the null terminated name/value attribute array are only valid for
+        // the duration of the call; character data may arrive in pieces.
+        struct SHandler{
+            virtual ~SHandler(){};
+            virtual void StartElement(const char *, const char **){};
+            virtual void EndElement(const char *){};
+            virtual void CharData(const char *, std::size_t){};
+        };
+
         CXMLReader(std::shared_ptr< CDataSource > src);
         ~CXMLReader();
         
         bool End() const;
         bool ReadEntity(SXMLEntity &entity, bool skipcdata = false);
+        bool Parse(SHandler &handler);
+
+        // Only the listed elements are reported; any other element is
+        // dropped together with everything nested inside it. The root
+        // element must be listed for anything to get through.
+        void AllowElements(const std::vector< std::string > &names);
+        // Only the listed attributes of the named element are reported
+        void AllowAttributes(const std::string &element, const std::vector< std::string > &attributes);
 };
 
 #endif
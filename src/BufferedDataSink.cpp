@@ -0,0 +1,46 @@
+#include "BufferedDataSink.h"
+
+CBufferedDataSink::CBufferedDataSink(std::shared_ptr< CDataSink > sink, std::size_t capacity) : DSink(std::move(sink)), DCapacity(capacity ? capacity : 1){
+    DBuffer.reserve(DCapacity);
+}
+
+CBufferedDataSink::~CBufferedDataSink(){
+    Flush();
+}
+
+bool CBufferedDataSink::Put(const char &ch) noexcept{
+    if(DBuffer.size() >= DCapacity && !Flush()){
+        return false;
+    }
+    DBuffer.push_back(ch);
+    return true;
+}
+
+bool CBufferedDataSink::Write(const std::vector<char> &buf) noexcept{
+    return Write(buf.data(),buf.size());
+}
+
+bool CBufferedDataSink::Write(const char *data, std::size_t size) noexcept{
+    if(DBuffer.size() + size > DCapacity){
+        if(!Flush()){
+            return false;
+        }
+        // Blocks at least as large as the buffer skip it entirely
+        if(size >= DCapacity){
+            return DSink->Write(data,size);
+        }
+    }
+    DBuffer.insert(DBuffer.end(),data,data + size);
+    return true;
+}
+
+bool CBufferedDataSink::Flush() noexcept{
+    if(!DBuffer.empty()){
+        bool Success = DSink->Write(DBuffer.data(),DBuffer.size());
+        DBuffer.clear();
+        if(!Success){
+            return false;
+        }
+    }
+    return DSink->Flush();
+}
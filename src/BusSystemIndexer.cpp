@@ -2,13 +2,26 @@
 #include "BusSystemIndexer.h"
 #include <vector>
 #include <unordered_map>
+#include <utility>
 #include <algorithm>
 
 struct CBusSystemIndexer::SImplementation {
+    using TStopID = CBusSystem::TStopID;
+    using TSegment = std::pair<TStopID, TStopID>;
+
+    struct SSegmentHash {
+        std::size_t operator()(const TSegment &segment) const noexcept {
+            std::hash<TStopID> hasher;
+            return hasher(segment.first) ^ (hasher(segment.second) + 0x9e3779b97f4a7c15ULL + (hasher(segment.first) << 6) + (hasher(segment.first) >> 2));
+        }
+    };
+
     std::shared_ptr<CBusSystem> busSystem;
     std::vector<std::shared_ptr<CBusSystem::SStop>> sortedStops; // sort by stop
     std::vector<std::shared_ptr<CBusSystem::SRoute>> sortedRoutes; // sort by route name 
     std::unordered_map<CStreetMap::TNodeID, std::shared_ptr<CBusSystem::SStop>> nodeToStop; // Mapping {node ID: corresponding stop}
+    std::unordered_map<TSegment, std::vector<std::shared_ptr<CBusSystem::SRoute>>, SSegmentHash> segmentRoutes; // consecutive stops, stored in both directions
+    std::unordered_map<TStopID, std::vector<std::pair<std::shared_ptr<CBusSystem::SRoute>, std::size_t>>> stopPositions; // {stop ID: (route, index in route)}
 
     SImplementation(std::shared_ptr<CBusSystem> bs) : busSystem(bs){
         std::size_t stopCount = busSystem->StopCount();
@@ -29,7 +42,7 @@ struct CBusSystemIndexer::SImplementation {
         }
         
         std::size_t routeCount = busSystem->RouteCount();
-        sortedStops.reserve(routeCount);
+        sortedRoutes.reserve(routeCount);
         for (std::size_t i = 0; i < routeCount; i++) {  // populate sortedRoutes
             auto route = busSystem->RouteByIndex(i);
             if (route) {
@@ -37,9 +50,32 @@ struct CBusSystemIndexer::SImplementation {
             }
         }
         // sort Routes by name 
-        std::sort(sortedRoutes.begin(), sortedRoutes.end(), [](const auto &a){
+        std::sort(sortedRoutes.begin(), sortedRoutes.end(), [](const auto &a, const auto &b){
             return a->Name() < b->Name();
         });
+
+        // index every stop visit and every pair of consecutive stops
+        for (const auto &route : sortedRoutes) {
+            std::size_t count = route->StopCount();
+            TStopID prevStopID = CBusSystem::InvalidStopID;
+            for (std::size_t i = 0; i < count; i++) {
+                TStopID stopID = route->GetStopID(i);
+                stopPositions[stopID].push_back({route, i});
+                if (i > 0) {
+                    AddSegmentRoute({prevStopID, stopID}, route);
+                    AddSegmentRoute({stopID, prevStopID}, route);
+                }
+                prevStopID = stopID;
+            }
+        }
+    }
+
+    void AddSegmentRoute(const TSegment &segment, const std::shared_ptr<CBusSystem::SRoute> &route) {
+        auto &routes = segmentRoutes[segment];
+        // routes are indexed one at a time, so a repeat can only be the last entry
+        if (routes.empty() || routes.back() != route) {
+            routes.push_back(route);
+        }
     }
 };
 
@@ -102,26 +138,35 @@ bool CBusSystemIndexer::RoutesByNodeIDs(TNodeID src, TNodeID dest,
         return false;
     }
 
-    auto srcID = srcStop->ID();
-    auto destID = destStop->ID();
-
-    for (const auto &route : DImplementation->sortedRoutes) {
-        std::size_t count = route->StopCount();
-        for (std::size_t i =0; i + 1 < count; ++i){
-            auto curStopId = route->GetStopID(i);
-            auto nextStopId = route->GetStopID(i+1);
-            // if a route has segments that connects two stops, insert into the unordered list
-            if((curStopId == srcID && nextStopId == destID) ||
-                (curStopId == destID & nextStopId == srcID)){
-                    routes.insert(route);
-                    break;
-                }
-        }
+    // segments are indexed in both directions, so one lookup covers either order
+    auto search = DImplementation->segmentRoutes.find({srcStop->ID(), destStop->ID()});
+    if (search == DImplementation->segmentRoutes.end()) {
+        return false;
     }
+    routes.insert(search->second.begin(), search->second.end());
     return !routes.empty();
 }
 
+// Returns true if at least one route has a route segment between the stops
+// at the src and dest node IDs.
 bool CBusSystemIndexer::RouteBetweenNodeIDs(TNodeID src, TNodeID dest) const noexcept {
-    std::unordered_set<std::shared_ptr<CBusSystem::SRoute>> emptyRoutes;
-    return RoutesByNodeIDs(src, dest, emptyRoutes);
+    auto srcStop = StopByNodeID(src);
+    auto destStop = StopByNodeID(dest);
+    if (!srcStop || !destStop) {
+        return false;
+    }
+    return DImplementation->segmentRoutes.find({srcStop->ID(), destStop->ID()}) != DImplementation->segmentRoutes.end();
+}
+
+// Returns true if the stop is visited by any route. Each visit is placed in
+// positions as the route and the index of the stop within that route.
+bool CBusSystemIndexer::RoutePositionsByStopID(TStopID id,
+    std::vector<std::pair<std::shared_ptr<CBusSystem::SRoute>, std::size_t>> &positions) const noexcept {
+    positions.clear();
+    auto search = DImplementation->stopPositions.find(id);
+    if (search == DImplementation->stopPositions.end()) {
+        return false;
+    }
+    positions = search->second;
+    return true;
 }
\ No newline at end of file
@@ -1,9 +1,28 @@
 #include "BusSystem.h"
 #include "CSVBusSystem.h"
 #include "DSVReader.h"
+#include "DSVTableReader.h"
 #include "StreetMap.h"
 #include <vector>
 #include <map>
+#include <string_view>
+
+// Column of the heading, tables without it fall back to the position
+static std::size_t ColumnOrDefault(const CDSVTableReader &table, const std::string &heading, std::size_t position) {
+    std::size_t Column = table.ColumnIndex(heading);
+    return Column == CDSVTableReader::InvalidColumn ? position : Column;
+}
+
+// A table with none of the expected headings has no heading row, its first
+// row is data
+static void HeadingsOrData(CDSVTableReader &table, const std::vector<std::string> &headings) {
+    for (auto &Heading : headings) {
+        if (table.ColumnIndex(Heading) != CDSVTableReader::InvalidColumn) {
+            return;
+        }
+    }
+    table.HeadingsAreData();
+}
 
 struct CCSVBusSystem:: SImplementation {
     // stop {stop_id,node_id 22043,2849810514}
@@ -59,37 +78,37 @@ struct CCSVBusSystem:: SImplementation {
 
 CCSVBusSystem::CCSVBusSystem(std::shared_ptr<CDSVReader> stopsrc, std::shared_ptr<CDSVReader> routesrc) {
     DImplementation = std::make_unique<SImplementation>();
-    std::vector<std::string> row;
+    // large tables are parsed on all cores
+    stopsrc->EnableParallel();
+    routesrc->EnableParallel();
 
     // parse stop CSV, expect stop_id, node_id
-    while (stopsrc->ReadRow(row)) {
-        if (row.size() >= 2) {
-            try {
-                TStopID stopId = std::stoull(row[0]);
-                CStreetMap::TNodeID nodeId = std::stoull(row[1]);
-                auto stop = std::make_shared<SImplementation::Stop>(stopId, nodeId);
-                DImplementation->DStopsById[stopId] = stop;
-                DImplementation->DStopsOrdered.push_back(stop);
-            } catch (const std::invalid_argument& e) {
-                // Skip this row for header and invalid input
-                continue;
-            }
+    CDSVTableReader stopTable(stopsrc);
+    HeadingsOrData(stopTable, {"stop_id", "node_id"});
+    std::size_t stopIdColumn = ColumnOrDefault(stopTable, "stop_id", 0);
+    std::size_t nodeIdColumn = ColumnOrDefault(stopTable, "node_id", 1);
+    while (stopTable.ReadRow()) {
+        TStopID stopId;
+        CStreetMap::TNodeID nodeId;
+        // Skip invalid rows, they are counted by the table
+        if (stopTable.Unsigned(stopIdColumn, stopId) && stopTable.Unsigned(nodeIdColumn, nodeId)) {
+            auto stop = std::make_shared<SImplementation::Stop>(stopId, nodeId);
+            DImplementation->DStopsById[stopId] = stop;
+            DImplementation->DStopsOrdered.push_back(stop);
         }
     }
 
     // parse rout csvm expect rout_name, stop_id
+    CDSVTableReader routeTable(routesrc);
+    HeadingsOrData(routeTable, {"route", "stop_id"});
+    std::size_t routeColumn = ColumnOrDefault(routeTable, "route", 0);
+    std::size_t routeStopIdColumn = ColumnOrDefault(routeTable, "stop_id", 1);
     std::map<std::string, std::vector<TStopID>> stop_per_route;
-    while (routesrc->ReadRow(row)) {
-        if (row.size() >= 2) {
-            try {
-                std::string routeName = row[0];
-                TStopID stopId = std::stoull(row[1]); 
-                stop_per_route[routeName].push_back(stopId);
-            }
-            catch (const std::invalid_argument& e) { 
-                continue; 
-            }
-
+    while (routeTable.ReadRow()) {
+        std::string_view routeName;
+        TStopID stopId;
+        if (routeTable.Cell(routeColumn, routeName) && routeTable.Unsigned(routeStopIdColumn, stopId)) {
+            stop_per_route[std::string(routeName)].push_back(stopId);
         }
     }
 
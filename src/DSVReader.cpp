@@ -2,14 +2,440 @@
 #include "DataSource.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Length of the leading run of data holding no special character. Outside
+// quotes the delimiter, quote and line endings are special, inside quotes
+// only the quote is. Scans 32 or 16 bytes at a time where AVX2 or SSE2 is
+// available and finishes byte by byte.
+static std::size_t PlainRunLength(const char *data, std::size_t size, char delimiter, bool inquotes) {
+    std::size_t Index = 0;
+#if defined(__AVX2__)
+    const __m256i Quote256 = _mm256_set1_epi8('"');
+    const __m256i Delimiter256 = _mm256_set1_epi8(delimiter);
+    const __m256i Newline256 = _mm256_set1_epi8('\n');
+    const __m256i Return256 = _mm256_set1_epi8('\r');
+    for (; Index + 32 <= size; Index += 32) {
+        __m256i Chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + Index));
+        __m256i Match = _mm256_cmpeq_epi8(Chunk, Quote256);
+        if (!inquotes) {
+            Match = _mm256_or_si256(Match, _mm256_cmpeq_epi8(Chunk, Delimiter256));
+            Match = _mm256_or_si256(Match, _mm256_cmpeq_epi8(Chunk, Newline256));
+            Match = _mm256_or_si256(Match, _mm256_cmpeq_epi8(Chunk, Return256));
+        }
+        unsigned Mask = static_cast<unsigned>(_mm256_movemask_epi8(Match));
+        if (Mask) {
+            return Index + __builtin_ctz(Mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i Quote128 = _mm_set1_epi8('"');
+    const __m128i Delimiter128 = _mm_set1_epi8(delimiter);
+    const __m128i Newline128 = _mm_set1_epi8('\n');
+    const __m128i Return128 = _mm_set1_epi8('\r');
+    for (; Index + 16 <= size; Index += 16) {
+        __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + Index));
+        __m128i Match = _mm_cmpeq_epi8(Chunk, Quote128);
+        if (!inquotes) {
+            Match = _mm_or_si128(Match, _mm_cmpeq_epi8(Chunk, Delimiter128));
+            Match = _mm_or_si128(Match, _mm_cmpeq_epi8(Chunk, Newline128));
+            Match = _mm_or_si128(Match, _mm_cmpeq_epi8(Chunk, Return128));
+        }
+        unsigned Mask = static_cast<unsigned>(_mm_movemask_epi8(Match));
+        if (Mask) {
+            return Index + __builtin_ctz(Mask);
+        }
+    }
+#endif
+    for (; Index < size; Index++) {
+        char Ch = data[Index];
+        if (Ch == '"' || (!inquotes && (Ch == delimiter || Ch == '\n' || Ch == '\r'))) {
+            break;
+        }
+    }
+    return Index;
+}
 
 struct CDSVReader::SImplementation {
+    // A parsed cell, either a slice of the row data or, when quotes had to
+    // be removed, a slice of a cell buffer
+    struct SCell {
+        bool Copied;
+        std::size_t Offset;
+        std::size_t Length;
+    };
+
+    // Rows parsed from data[Begin, End) by one worker of a parallel load.
+    // RowEnds holds the index one past the last cell of each row.
+    struct SChunk {
+        std::size_t Begin;
+        std::size_t End;
+        bool Complete = false;
+        std::vector<SCell> Cells;
+        std::vector<std::size_t> RowEnds;
+        std::string CellBuffer;
+    };
+
     std::shared_ptr<CDataSource> DataSource;
     char Delimiter;
     bool ifend;
-    
+
+    // Data consumed from the source but not parsed yet, only used when a row
+    // does not fit in a single borrowed region
+    std::string Pending;
+    std::size_t PendingIndex;
+
+    // Cells of the last row read when reading a row at a time
+    std::vector<SCell> Cells;
+    std::string CellBuffer;
+
+    // Parallel loading of a large borrowed region, see EnableParallel
+    bool Parallel;
+    std::size_t ParallelThreshold;
+    std::size_t ParallelThreads;
+    std::vector<SChunk> Chunks;
+    std::size_t ChunkIndex;
+    std::size_t ChunkRowIndex;
+    std::size_t ChunkRowsLeft;
+
+    // Last row read, its cells point into RowData or RowCellBuffer
+    const char *RowData;
+    const SCell *RowCells;
+    std::size_t RowCellCount;
+    const std::string *RowCellBuffer;
+
     SImplementation(std::shared_ptr<CDataSource> src, char del)
-        : DataSource(std::move(src)), Delimiter(del), ifend(false) {}
+        : DataSource(std::move(src)), Delimiter(del), ifend(false), PendingIndex(0), Parallel(false), ParallelThreshold(0), ParallelThreads(0),
+          ChunkIndex(0), ChunkRowIndex(0), ChunkRowsLeft(0), RowData(nullptr), RowCells(nullptr), RowCellCount(0), RowCellBuffer(nullptr) {}
+
+    // Add data[begin, end) to the cell, copying it into the cell buffer once
+    // the cell stops being one contiguous slice
+    static void AppendToCell(SCell &cell, std::string &cellbuffer, const char *data, std::size_t begin, std::size_t end) {
+        if (begin == end) {
+            return;
+        }
+        if (!cell.Copied) {
+            if (cell.Length == 0) {
+                cell.Offset = begin;
+                cell.Length = end - begin;
+                return;
+            }
+            if (cell.Offset + cell.Length == begin) {
+                cell.Length += end - begin;
+                return;
+            }
+            std::size_t CopyOffset = cellbuffer.size();
+            cellbuffer.append(data + cell.Offset, cell.Length);
+            cell.Offset = CopyOffset;
+            cell.Copied = true;
+        }
+        cellbuffer.append(data + begin, end - begin);
+        cell.Length += end - begin;
+    }
+
+    // Parse one row from data[begin, size), appending its cells. Returns
+    // false if the row may continue past size, which can only happen when
+    // final is false, and leaves cells and cellbuffer as they were. On
+    // success rowend is the index just past the line ending.
+    // A cell that opens with a quote is quoted until the next single quote,
+    // doubled quotes anywhere become one quote and other quotes are dropped.
+    bool ParseRow(const char *data, std::size_t begin, std::size_t size, bool final, std::size_t &rowend, std::vector<SCell> &cells, std::string &cellbuffer) const {
+        std::size_t FirstCell = cells.size();
+        std::size_t FirstCopy = cellbuffer.size();
+        std::size_t Index = begin;
+        while (true) {
+            SCell Cell{false, Index, 0};
+            bool InQuotes = false;
+            if (Index < size && data[Index] == '"') {
+                InQuotes = true;
+                Index++;
+                Cell.Offset = Index;
+            }
+            while (true) {
+                std::size_t RunStart = Index;
+                Index += PlainRunLength(data + Index, size - Index, Delimiter, InQuotes);
+                AppendToCell(Cell, cellbuffer, data, RunStart, Index);
+                if (Index >= size) {
+                    if (!final) {
+                        cells.resize(FirstCell);
+                        cellbuffer.resize(FirstCopy);
+                        return false;
+                    }
+                    if (Cell.Length || cells.size() > FirstCell) {
+                        cells.push_back(Cell);
+                    }
+                    rowend = size;
+                    return true;
+                }
+                if (data[Index] != '"') {
+                    break;
+                }
+                if (Index + 1 >= size && !final) {
+                    cells.resize(FirstCell);
+                    cellbuffer.resize(FirstCopy);
+                    return false;
+                }
+                if (Index + 1 < size && data[Index + 1] == '"') {
+                    AppendToCell(Cell, cellbuffer, data, Index, Index + 1);
+                    Index += 2;
+                }
+                else {
+                    InQuotes = false;
+                    Index++;
+                }
+            }
+            cells.push_back(Cell);
+            if (data[Index] == Delimiter) {
+                Index++;
+                continue;
+            }
+            if (data[Index] == '\r') {
+                if (Index + 1 >= size && !final) {
+                    cells.resize(FirstCell);
+                    cellbuffer.resize(FirstCopy);
+                    return false;
+                }
+                if (Index + 1 < size && data[Index + 1] == '\n') {
+                    Index++;
+                }
+            }
+            rowend = Index + 1;
+            return true;
+        }
+    }
+
+    // Parse every row of a chunk. The chunk is incomplete if its last row
+    // runs past its end, which means the chunk did not end on a row boundary.
+    void ParseChunk(const char *data, std::size_t size, SChunk &chunk) const {
+        chunk.Cells.clear();
+        chunk.RowEnds.clear();
+        chunk.CellBuffer.clear();
+        bool Final = chunk.End == size;
+        std::size_t Index = chunk.Begin;
+        while (Index < chunk.End) {
+            std::size_t RowEnd;
+            if (!ParseRow(data, Index, chunk.End, Final, RowEnd, chunk.Cells, chunk.CellBuffer)) {
+                chunk.Complete = false;
+                return;
+            }
+            if (chunk.RowEnds.empty() ? !chunk.Cells.empty() : chunk.Cells.size() > chunk.RowEnds.back()) {
+                chunk.RowEnds.push_back(chunk.Cells.size());
+            }
+            Index = RowEnd;
+        }
+        chunk.Complete = true;
+    }
+
+    // Split data into chunks at line feeds, parse them on worker threads and
+    // merge any chunk that turned out to end inside a quoted cell with the
+    // one after it. Chunk 0 starts on a row, so by induction every complete
+    // chunk ends on one.
+    void ParseParallel(const char *data, std::size_t size) {
+        std::size_t ThreadCount = ParallelThreads;
+        std::size_t ChunkCount = std::max<std::size_t>(1, std::min(ThreadCount * 4, size / 4096));
+        Chunks.clear();
+        std::size_t Begin = 0;
+        for (std::size_t Index = 1; Index <= ChunkCount && Begin < size; Index++) {
+            std::size_t End = size;
+            if (Index < ChunkCount) {
+                std::size_t Nominal = std::max(Begin, size / ChunkCount * Index);
+                const void *LineFeed = std::memchr(data + Nominal, '\n', size - Nominal);
+                End = LineFeed ? static_cast<const char *>(LineFeed) - data + 1 : size;
+            }
+            SChunk Chunk;
+            Chunk.Begin = Begin;
+            Chunk.End = End;
+            Chunks.push_back(std::move(Chunk));
+            Begin = End;
+        }
+
+        std::atomic<std::size_t> NextChunk(0);
+        auto Worker = [&]() {
+            for (std::size_t Index = NextChunk++; Index < Chunks.size(); Index = NextChunk++) {
+                ParseChunk(data, size, Chunks[Index]);
+            }
+        };
+        std::vector<std::thread> Workers;
+        for (std::size_t Index = 1; Index < std::min(ThreadCount, Chunks.size()); Index++) {
+            Workers.emplace_back(Worker);
+        }
+        Worker();
+        for (auto &Thread : Workers) {
+            Thread.join();
+        }
+
+        for (std::size_t Index = 0; Index < Chunks.size(); Index++) {
+            while (!Chunks[Index].Complete) {
+                Chunks[Index].End = Chunks[Index + 1].End;
+                Chunks.erase(Chunks.begin() + Index + 1);
+                ParseChunk(data, size, Chunks[Index]);
+            }
+        }
+        ChunkIndex = 0;
+        ChunkRowIndex = 0;
+        ChunkRowsLeft = 0;
+        for (const auto &Chunk : Chunks) {
+            ChunkRowsLeft += Chunk.RowEnds.size();
+        }
+    }
+
+    // Skip to the next chunk row, false once the parallel load is used up
+    bool SkipEmptyChunks() {
+        while (ChunkIndex < Chunks.size() && ChunkRowIndex >= Chunks[ChunkIndex].RowEnds.size()) {
+            ChunkIndex++;
+            ChunkRowIndex = 0;
+        }
+        if (ChunkIndex >= Chunks.size()) {
+            Chunks.clear();
+            return false;
+        }
+        return true;
+    }
+
+    // Serve the next row of a parallel load
+    bool NextChunkRow() {
+        if (!SkipEmptyChunks()) {
+            return false;
+        }
+        const SChunk &Chunk = Chunks[ChunkIndex];
+        std::size_t FirstCell = ChunkRowIndex ? Chunk.RowEnds[ChunkRowIndex - 1] : 0;
+        RowCells = Chunk.Cells.data() + FirstCell;
+        RowCellCount = Chunk.RowEnds[ChunkRowIndex] - FirstCell;
+        RowCellBuffer = &Chunk.CellBuffer;
+        ChunkRowIndex++;
+        // The rows of a parallel load are the rest of the source, so the
+        // reader ends with the last of them
+        if (--ChunkRowsLeft == 0) {
+            ifend = true;
+        }
+        return true;
+    }
+
+    void SetRow(const char *data) {
+        RowData = data;
+        RowCells = Cells.data();
+        RowCellCount = Cells.size();
+        RowCellBuffer = &CellBuffer;
+    }
+
+    // Read the next row, parsing straight out of the borrowed region when the
+    // whole row is in it
+    bool ReadCells() {
+        if (ifend) {
+            return false;
+        }
+        if (NextChunkRow()) {
+            return true;
+        }
+        std::size_t RowLength;
+        const char *Data;
+        std::size_t Size;
+        std::size_t Begin = 0;
+        Cells.clear();
+        CellBuffer.clear();
+        if (PendingIndex >= Pending.size()) {
+            Pending.clear();
+            PendingIndex = 0;
+            if (!DataSource->Borrow(Data, Size)) {
+                ifend = true;
+                return false;
+            }
+            if (Parallel && Size >= ParallelThreshold) {
+                // Only split the region if it is all that is left
+                DataSource->Consume(Size);
+                if (DataSource->End()) {
+                    ParseParallel(Data, Size);
+                    RowData = Data;
+                    if (NextChunkRow()) {
+                        return true;
+                    }
+                    ifend = true;
+                    return false;
+                }
+                Pending.assign(Data, Size);
+            }
+            else if (ParseRow(Data, 0, Size, false, RowLength, Cells, CellBuffer)) {
+                SetRow(Data);
+                DataSource->Consume(RowLength);
+                if (DataSource->End()) {
+                    ifend = true;
+                }
+                return true;
+            }
+            else {
+                Pending.assign(Data, Size);
+                DataSource->Consume(Size);
+            }
+        }
+        else {
+            // Rows left over from a region consumed whole are parsed in place
+            Begin = PendingIndex;
+        }
+
+        // The row spans borrowed regions, gather them until it is complete.
+        // Only reparse once a line ending arrives or a lookahead is resolved.
+        // Regions the row runs through are consumed whole, and the region a
+        // reparse is waiting on is consumed once the row is known to go on.
+        // Parsed rows are only dropped from Pending when it is refilled.
+        bool Final = false;
+        bool Reparse = true;
+        std::size_t Unconsumed = 0;
+        while (!Reparse || !ParseRow(Pending.data(), Begin, Pending.size(), Final, RowLength, Cells, CellBuffer)) {
+            if (Unconsumed) {
+                DataSource->Consume(Unconsumed);
+                Unconsumed = 0;
+            }
+            if (Final) {
+                break;
+            }
+            char Last = Pending.size() > Begin ? Pending.back() : '\0';
+            if (!DataSource->Borrow(Data, Size)) {
+                Final = true;
+                Reparse = true;
+                continue;
+            }
+            if (Begin) {
+                Pending.erase(0, Begin);
+                Begin = 0;
+            }
+            Pending.append(Data, Size);
+            Reparse = Last == '"' || Last == '\r' || std::memchr(Data, '\n', Size) || std::memchr(Data, '\r', Size);
+            if (Reparse) {
+                Unconsumed = Size;
+            }
+            else {
+                DataSource->Consume(Size);
+            }
+        }
+        if (Unconsumed) {
+            // Leave the source at the end of the row, the rest of the region
+            // (a lookahead character, or following rows) is borrowed again
+            DataSource->Consume(Unconsumed - (Pending.size() - RowLength));
+            Pending.resize(RowLength);
+        }
+        SetRow(Pending.data());
+        PendingIndex = RowLength;
+        if (PendingIndex >= Pending.size() && (Final || DataSource->End())) {
+            ifend = true;
+        }
+        if (Cells.empty()) {
+            ifend = true;
+            return false;
+        }
+        return true;
+    }
+
+    std::string_view CellView(const SCell &cell) const {
+        return std::string_view((cell.Copied ? RowCellBuffer->data() : RowData) + cell.Offset, cell.Length);
+    }
 };
 
 CDSVReader::CDSVReader(std::shared_ptr<CDataSource> src, char delimiter)
@@ -21,86 +447,36 @@ bool CDSVReader::End() const {
     return DImplementation->ifend;
 }
 
+void CDSVReader::EnableParallel(std::size_t threshold, std::size_t threads){
+    if (!threads) {
+        threads = std::thread::hardware_concurrency();
+    }
+    // Buffering every row only pays off when there are threads to share it
+    DImplementation->Parallel = threads > 1;
+    DImplementation->ParallelThreshold = threshold;
+    DImplementation->ParallelThreads = threads;
+}
+
 bool CDSVReader::ReadRow(std::vector<std::string> &row){
-    if (DImplementation->ifend) {
+    row.clear();
+    if (!DImplementation->ReadCells()) {
         return false;
     }
+    row.reserve(DImplementation->RowCellCount);
+    for (std::size_t Index = 0; Index < DImplementation->RowCellCount; Index++) {
+        row.emplace_back(DImplementation->CellView(DImplementation->RowCells[Index]));
+    }
+    return true;
+}
 
+bool CDSVReader::ReadRowView(std::vector<std::string_view> &row){
     row.clear();
-    std::string cell;
-    bool inQuotes = false;
-    bool firstChar = true;
-
-    while (true) {
-        if (DImplementation->DataSource->End()) {
-            DImplementation->ifend = true;
-            if (!cell.empty() || !row.empty())
-                row.push_back(cell);
-            return !row.empty();
-        }
-
-        char ch;
-        if (!DImplementation->DataSource->Get(ch)) {
-            DImplementation->ifend = true;
-            if (!cell.empty() || !row.empty())
-                row.push_back(cell);
-            return !row.empty();
-        }
-
-        if (firstChar) {
-            if (ch == '"') {
-                inQuotes = true;
-                firstChar = false;
-                continue;
-            }
-            firstChar = false;
-        }
-
-        if (inQuotes) {
-            if (ch == '"') {
-                char peekch;
-                if (DImplementation->DataSource->Peek(peekch)) {
-                    if (peekch == '"') {
-                        cell.push_back('"');
-                        DImplementation->DataSource->Get(ch);
-                    } else {
-                        inQuotes = false;
-                    }
-                } else {
-                    inQuotes = false;
-                }
-            } else {
-                cell.push_back(ch);
-            }
-        } else {
-            if (ch == DImplementation->Delimiter) {
-                row.push_back(cell);
-                cell.clear();
-                firstChar = true;
-            } else if (ch == '\n' || ch == '\r') {
-                row.push_back(cell);
-                if (ch == '\r') {
-                    char next;
-                    if (DImplementation->DataSource->Peek(next) && next == '\n') {
-                        DImplementation->DataSource->Get(next);
-                    }
-                }
-                if (DImplementation->DataSource->End()) {
-                    DImplementation->ifend = true;
-                }
-                return !row.empty();
-            } else if (ch == '"'){ // two consecutive double quotes are changed into one 
-                char peekch;
-                if (DImplementation->DataSource->Peek(peekch)) {
-                    if (peekch == '"') {
-                        cell.push_back('"');
-                        DImplementation->DataSource->Get(ch);
-                    }
-                }
-            } else {
-                cell.push_back(ch);
-            }
-
+    if (!DImplementation->ReadCells()) {
+        return false;
     }
+    row.reserve(DImplementation->RowCellCount);
+    for (std::size_t Index = 0; Index < DImplementation->RowCellCount; Index++) {
+        row.push_back(DImplementation->CellView(DImplementation->RowCells[Index]));
     }
-}
\ No newline at end of file
+    return true;
+}
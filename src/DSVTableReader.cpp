@@ -0,0 +1,128 @@
+#include "DSVTableReader.h"
+#include <charconv>
+#include <cstdlib>
+
+struct CDSVTableReader::SImplementation {
+    std::shared_ptr<CDSVReader> Reader;
+    std::vector<std::string> Headings;
+    std::vector<std::string_view> Row;
+    // First row when it turned out to be data, returned by the next ReadRow
+    std::vector<std::string> FirstRow;
+    bool FirstRowPending = false;
+    std::size_t RowCount;
+    std::size_t ErrorCount;
+
+    SImplementation(std::shared_ptr<CDSVReader> reader)
+        : Reader(std::move(reader)), RowCount(0), ErrorCount(0) {
+        if (Reader->ReadRowView(Row)) {
+            Headings.assign(Row.begin(), Row.end());
+        }
+        Row.clear();
+    }
+
+    bool Cell(std::size_t column, std::string_view &value) {
+        if (column >= Row.size()) {
+            ErrorCount++;
+            return false;
+        }
+        value = Row[column];
+        return true;
+    }
+
+    // The whole cell must be the number, anything else is an error
+    template <typename T>
+    bool Parse(std::size_t column, T &value) {
+        std::string_view Text;
+        if (!Cell(column, Text)) {
+            return false;
+        }
+        const char *End = Text.data() + Text.size();
+        auto Result = std::from_chars(Text.data(), End, value);
+        if (Result.ec != std::errc() || Result.ptr != End || Text.empty()) {
+            ErrorCount++;
+            return false;
+        }
+        return true;
+    }
+};
+
+CDSVTableReader::CDSVTableReader(std::shared_ptr<CDSVReader> reader)
+    : DImplementation(std::make_unique<SImplementation>(std::move(reader))) {}
+
+CDSVTableReader::~CDSVTableReader() = default;
+
+const std::vector<std::string> &CDSVTableReader::Headings() const {
+    return DImplementation->Headings;
+}
+
+std::size_t CDSVTableReader::ColumnIndex(const std::string &heading) const {
+    for (std::size_t Index = 0; Index < DImplementation->Headings.size(); Index++) {
+        if (DImplementation->Headings[Index] == heading) {
+            return Index;
+        }
+    }
+    return InvalidColumn;
+}
+
+void CDSVTableReader::HeadingsAreData() {
+    if (DImplementation->Headings.empty() || DImplementation->RowCount) {
+        return;
+    }
+    DImplementation->FirstRow = std::move(DImplementation->Headings);
+    DImplementation->Headings.clear();
+    DImplementation->FirstRowPending = true;
+}
+
+bool CDSVTableReader::End() const {
+    return !DImplementation->FirstRowPending && DImplementation->Reader->End();
+}
+
+bool CDSVTableReader::ReadRow() {
+    if (DImplementation->FirstRowPending) {
+        DImplementation->FirstRowPending = false;
+        DImplementation->Row.assign(DImplementation->FirstRow.begin(), DImplementation->FirstRow.end());
+        DImplementation->RowCount++;
+        return true;
+    }
+    if (!DImplementation->Reader->ReadRowView(DImplementation->Row)) {
+        return false;
+    }
+    DImplementation->RowCount++;
+    return true;
+}
+
+std::size_t CDSVTableReader::RowCount() const {
+    return DImplementation->RowCount;
+}
+
+std::size_t CDSVTableReader::ErrorCount() const {
+    return DImplementation->ErrorCount;
+}
+
+bool CDSVTableReader::Cell(std::size_t column, std::string_view &value) {
+    return DImplementation->Cell(column, value);
+}
+
+bool CDSVTableReader::Unsigned(std::size_t column, uint64_t &value) {
+    return DImplementation->Parse(column, value);
+}
+
+bool CDSVTableReader::Double(std::size_t column, double &value) {
+#if defined(__cpp_lib_to_chars)
+    return DImplementation->Parse(column, value);
+#else
+    // Standard libraries without floating point from_chars parse a copy
+    std::string_view Text;
+    if (!DImplementation->Cell(column, Text)) {
+        return false;
+    }
+    std::string Copy(Text);
+    char *End = nullptr;
+    value = std::strtod(Copy.c_str(), &End);
+    if (Copy.empty() || End != Copy.c_str() + Copy.size()) {
+        DImplementation->ErrorCount++;
+        return false;
+    }
+    return true;
+#endif
+}
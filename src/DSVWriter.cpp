@@ -63,8 +63,7 @@ bool CDSVWriter::WriteRow(const std::vector<std::string> &buf) {
     row.push_back('\n');
 
     // Write to sink
-    std::vector<char> buffer(row.begin(), row.end());
-    if (!DImplementation->Sink->Write(buffer)) {
+    if (!DImplementation->Sink->Write(row.data(), row.size())) {
         return false;
     }
 
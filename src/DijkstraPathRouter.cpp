@@ -1,4 +1,5 @@
 #include "DijkstraPathRouter.h"
+#include "SearchWorkspace.h"
 #include <queue>
 #include <vector>
 #include <limits>
@@ -11,9 +12,343 @@ struct Edge {
     double weight;
 };
 
+// Edge of the contraction hierarchy. middle is the contracted vertex a
+// shortcut bypasses, or InvalidVertexID for an original edge.
+struct HierarchyEdge {
+    CPathRouter::TVertexID other;
+    double weight;
+    CPathRouter::TVertexID middle;
+};
+
 struct CDijkstraPathRouter::SImplementation {
     std::vector<std::any> vertices; // stores tag for each vertex. Index serves as vertex ID
     std::vector<std::vector<Edge>> adjacencyList; // adjacency list: for each vertex
+    std::vector<std::vector<Edge>> reverseAdjacencyList; // incoming edges, dest is the edge source
+
+    // Contraction hierarchy, only valid after a successful Precompute
+    bool hierarchyValid = false;
+    std::vector<std::size_t> rank; // contraction order of each vertex
+    std::vector<std::vector<HierarchyEdge>> upward; // v -> other, rank[other] > rank[v]
+    std::vector<std::vector<HierarchyEdge>> downward; // other -> v, rank[other] > rank[v]
+
+    static constexpr std::size_t WitnessSettleLimit = 500;
+
+    // Per-thread search state, reused across queries
+    static CSearchWorkspace &ForwardWorkspace() {
+        static thread_local CSearchWorkspace workspace;
+        return workspace;
+    }
+
+    static CSearchWorkspace &BackwardWorkspace() {
+        static thread_local CSearchWorkspace workspace;
+        return workspace;
+    }
+
+    static void RemoveEdgeTo(std::vector<HierarchyEdge> &edges, TVertexID other) {
+        for (std::size_t i = 0; i < edges.size(); i++) {
+            if (edges[i].other == other) {
+                edges[i] = edges.back();
+                edges.pop_back();
+                return;
+            }
+        }
+    }
+
+    // Inserts other into edges, keeping only the lightest edge per neighbor
+    static void InsertEdge(std::vector<HierarchyEdge> &edges, const HierarchyEdge &edge) {
+        for (auto &existing : edges) {
+            if (existing.other == edge.other) {
+                if (edge.weight < existing.weight) {
+                    existing = edge;
+                }
+                return;
+            }
+        }
+        edges.push_back(edge);
+    }
+
+    // Local Dijkstra from src that ignores the vertex being contracted. Stops
+    // once every remaining key exceeds maxDist or the settle limit is hit.
+    static void RunWitnessSearch(const std::vector<std::vector<HierarchyEdge>> &outs, CSearchWorkspace &search,
+                                 TVertexID src, TVertexID ignore, double maxDist) {
+        search.Reset(outs.size());
+        search.Update(src, 0.0, CPathRouter::InvalidVertexID);
+        search.Push(0.0, 0.0, src);
+        std::size_t settled = 0;
+        while (!search.QueueEmpty()) {
+            auto item = search.Pop();
+            double d = item.DDistance;
+            TVertexID u = item.DIndex;
+            if (d > search.Distance(u)) continue;
+            if (d > maxDist || ++settled > WitnessSettleLimit) break;
+            for (const auto &edge : outs[u]) {
+                if (edge.other == ignore) continue;
+                double alt = d + edge.weight;
+                if (alt < search.Distance(edge.other)) {
+                    search.Update(edge.other, alt, u);
+                    search.Push(alt, alt, edge.other);
+                }
+            }
+        }
+    }
+
+    // Contracts v (or only counts the shortcuts needed when simulate is true)
+    static int ContractVertex(std::vector<std::vector<HierarchyEdge>> &outs, std::vector<std::vector<HierarchyEdge>> &ins,
+                              CSearchWorkspace &search, TVertexID v, bool simulate) {
+        int shortcuts = 0;
+        double maxOut = 0.0;
+        for (const auto &out : outs[v]) {
+            maxOut = std::max(maxOut, out.weight);
+        }
+        for (const auto &in : ins[v]) {
+            TVertexID u = in.other;
+            RunWitnessSearch(outs, search, u, v, in.weight + maxOut);
+            for (const auto &out : outs[v]) {
+                TVertexID x = out.other;
+                if (x == u) continue;
+                double viaWeight = in.weight + out.weight;
+                if (search.Distance(x) <= viaWeight) continue;
+                shortcuts++;
+                if (!simulate) {
+                    InsertEdge(outs[u], {x, viaWeight, v});
+                    InsertEdge(ins[x], {u, viaWeight, v});
+                }
+            }
+        }
+        return shortcuts;
+    }
+
+    int EdgeDifference(std::vector<std::vector<HierarchyEdge>> &outs, std::vector<std::vector<HierarchyEdge>> &ins,
+                       CSearchWorkspace &search, const std::vector<int> &contractedNeighbors, TVertexID v) {
+        int shortcuts = ContractVertex(outs, ins, search, v, true);
+        return shortcuts - static_cast<int>(outs[v].size() + ins[v].size()) + contractedNeighbors[v];
+    }
+
+    bool BuildHierarchy(std::chrono::steady_clock::time_point deadline) {
+        std::size_t n = vertices.size();
+        hierarchyValid = false;
+
+        // Working graph without self loops and with parallel edges merged
+        std::vector<std::vector<HierarchyEdge>> outs(n), ins(n);
+        for (TVertexID u = 0; u < n; u++) {
+            for (const auto &edge : adjacencyList[u]) {
+                if (edge.dest == u) continue;
+                InsertEdge(outs[u], {edge.dest, edge.weight, CPathRouter::InvalidVertexID});
+                InsertEdge(ins[edge.dest], {u, edge.weight, CPathRouter::InvalidVertexID});
+            }
+        }
+
+        CSearchWorkspace search;
+        std::vector<int> contractedNeighbors(n, 0);
+        std::vector<std::size_t> order(n, 0);
+        std::vector<std::vector<HierarchyEdge>> up(n), down(n);
+
+        using Pair = std::pair<int, TVertexID>;
+        std::priority_queue<Pair, std::vector<Pair>, std::greater<Pair>> pq;
+        for (TVertexID v = 0; v < n; v++) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            pq.push({EdgeDifference(outs, ins, search, contractedNeighbors, v), v});
+        }
+
+        std::size_t nextRank = 0;
+        while (!pq.empty()) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            TVertexID v = pq.top().second;
+            pq.pop();
+            // Lazy update: re-evaluate and defer if no longer the minimum
+            int priority = EdgeDifference(outs, ins, search, contractedNeighbors, v);
+            if (!pq.empty() && priority > pq.top().first) {
+                pq.push({priority, v});
+                continue;
+            }
+
+            ContractVertex(outs, ins, search, v, false);
+            order[v] = nextRank++;
+            // Remaining neighbors are contracted later and so rank higher
+            for (const auto &out : outs[v]) {
+                up[v].push_back(out);
+                RemoveEdgeTo(ins[out.other], v);
+                contractedNeighbors[out.other]++;
+            }
+            for (const auto &in : ins[v]) {
+                down[v].push_back(in);
+                RemoveEdgeTo(outs[in.other], v);
+                contractedNeighbors[in.other]++;
+            }
+            outs[v].clear();
+            ins[v].clear();
+        }
+
+        rank = std::move(order);
+        upward = std::move(up);
+        downward = std::move(down);
+        hierarchyValid = true;
+        return true;
+    }
+
+    // Finds the hierarchy edge src -> dest, it is stored with the lower ranked vertex
+    const HierarchyEdge *FindHierarchyEdge(TVertexID src, TVertexID dest) const {
+        if (rank[src] < rank[dest]) {
+            for (const auto &edge : upward[src]) {
+                if (edge.other == dest) return &edge;
+            }
+        }
+        else {
+            for (const auto &edge : downward[dest]) {
+                if (edge.other == src) return &edge;
+            }
+        }
+        return nullptr;
+    }
+
+    // Expands the hierarchy edge src -> dest into original edges, appending
+    // every vertex after src to path and accumulating the original weights
+    void UnpackEdge(TVertexID src, TVertexID dest, std::vector<TVertexID> &path, double &cost) const {
+        const HierarchyEdge *edge = FindHierarchyEdge(src, dest);
+        if (edge->middle == CPathRouter::InvalidVertexID) {
+            cost += edge->weight;
+            path.push_back(dest);
+            return;
+        }
+        TVertexID middle = edge->middle;
+        UnpackEdge(src, middle, path, cost);
+        UnpackEdge(middle, dest, path, cost);
+    }
+
+    // Weight of the lightest edge from u to v
+    double EdgeWeight(TVertexID u, TVertexID v) const {
+        double weight = std::numeric_limits<double>::max();
+        for (const auto &edge : adjacencyList[u]) {
+            if (edge.dest == v) weight = std::min(weight, edge.weight);
+        }
+        return weight;
+    }
+
+    // Bidirectional Dijkstra: forward from src over adjacencyList, backward
+    // from dest over reverseAdjacencyList. Each step advances the direction
+    // with the smaller queue top, and the search stops once the two tops sum
+    // to at least the best meeting distance found so far.
+    double FindBidirectionalPath(TVertexID src, TVertexID dest, std::vector<TVertexID> &path) const {
+        std::size_t n = vertices.size();
+        CSearchWorkspace &forwardSearch = ForwardWorkspace();
+        CSearchWorkspace &backwardSearch = BackwardWorkspace();
+        forwardSearch.Reset(n);
+        backwardSearch.Reset(n);
+        forwardSearch.Update(src, 0.0, CPathRouter::InvalidVertexID);
+        backwardSearch.Update(dest, 0.0, CPathRouter::InvalidVertexID);
+        forwardSearch.Push(0.0, 0.0, src);
+        backwardSearch.Push(0.0, 0.0, dest);
+
+        double best = src == dest ? 0.0 : std::numeric_limits<double>::max();
+        TVertexID meet = src == dest ? src : CPathRouter::InvalidVertexID;
+        while (!forwardSearch.QueueEmpty() && !backwardSearch.QueueEmpty()) {
+            if (forwardSearch.Top().DKey + backwardSearch.Top().DKey >= best) break;
+            bool forward = forwardSearch.Top().DKey <= backwardSearch.Top().DKey;
+
+            auto &search = forward ? forwardSearch : backwardSearch;
+            const auto &otherSearch = forward ? backwardSearch : forwardSearch;
+            const auto &edges = forward ? adjacencyList : reverseAdjacencyList;
+
+            auto item = search.Pop();
+            double d = item.DDistance;
+            TVertexID u = item.DIndex;
+            if (d > search.Distance(u)) continue;
+            for (const auto &edge : edges[u]) {
+                TVertexID v = edge.dest;
+                double alt = d + edge.weight;
+                if (alt < search.Distance(v)) {
+                    search.Update(v, alt, u);
+                    search.Push(alt, alt, v);
+                    if (otherSearch.Reached(v) && alt + otherSearch.Distance(v) < best) {
+                        best = alt + otherSearch.Distance(v);
+                        meet = v;
+                    }
+                }
+            }
+        }
+        if (meet == CPathRouter::InvalidVertexID) {
+            return CPathRouter::NoPathExists;
+        }
+
+        for (TVertexID at = meet; at != CPathRouter::InvalidVertexID; at = forwardSearch.Previous(at)) {
+            path.push_back(at);
+        }
+        std::reverse(path.begin(), path.end());
+        // Sum the backward half in path order so the distance matches what a
+        // forward search along the same path reports
+        double cost = forwardSearch.Distance(meet);
+        for (TVertexID at = backwardSearch.Previous(meet); at != CPathRouter::InvalidVertexID; at = backwardSearch.Previous(at)) {
+            cost += EdgeWeight(path.back(), at);
+            path.push_back(at);
+        }
+        return cost;
+    }
+
+    // Bidirectional upward search over the contraction hierarchy
+    double FindHierarchyPath(TVertexID src, TVertexID dest, std::vector<TVertexID> &path) const {
+        std::size_t n = vertices.size();
+        CSearchWorkspace &forwardSearch = ForwardWorkspace();
+        CSearchWorkspace &backwardSearch = BackwardWorkspace();
+        forwardSearch.Reset(n);
+        backwardSearch.Reset(n);
+        forwardSearch.Update(src, 0.0, CPathRouter::InvalidVertexID);
+        backwardSearch.Update(dest, 0.0, CPathRouter::InvalidVertexID);
+        forwardSearch.Push(0.0, 0.0, src);
+        backwardSearch.Push(0.0, 0.0, dest);
+
+        double best = std::numeric_limits<double>::max();
+        TVertexID meet = CPathRouter::InvalidVertexID;
+        while (true) {
+            // A direction is done once its smallest key cannot improve best
+            bool forwardActive = !forwardSearch.QueueEmpty() && forwardSearch.Top().DKey < best;
+            bool backwardActive = !backwardSearch.QueueEmpty() && backwardSearch.Top().DKey < best;
+            if (!forwardActive && !backwardActive) break;
+            bool forward = forwardActive && (!backwardActive || forwardSearch.Top().DKey <= backwardSearch.Top().DKey);
+
+            auto &search = forward ? forwardSearch : backwardSearch;
+            const auto &otherSearch = forward ? backwardSearch : forwardSearch;
+            const auto &edges = forward ? upward : downward;
+
+            auto item = search.Pop();
+            double d = item.DDistance;
+            TVertexID u = item.DIndex;
+            if (d > search.Distance(u)) continue;
+            if (otherSearch.Reached(u) && d + otherSearch.Distance(u) < best) {
+                best = d + otherSearch.Distance(u);
+                meet = u;
+            }
+            for (const auto &edge : edges[u]) {
+                double alt = d + edge.weight;
+                if (alt < search.Distance(edge.other)) {
+                    search.Update(edge.other, alt, u);
+                    search.Push(alt, alt, edge.other);
+                }
+            }
+        }
+        if (meet == CPathRouter::InvalidVertexID) {
+            return CPathRouter::NoPathExists;
+        }
+
+        // Hierarchy vertices from src up to meet and back down to dest
+        std::vector<TVertexID> hierarchyPath;
+        for (TVertexID at = meet; at != CPathRouter::InvalidVertexID; at = forwardSearch.Previous(at)) {
+            hierarchyPath.push_back(at);
+        }
+        std::reverse(hierarchyPath.begin(), hierarchyPath.end());
+        for (TVertexID at = backwardSearch.Previous(meet); at != CPathRouter::InvalidVertexID; at = backwardSearch.Previous(at)) {
+            hierarchyPath.push_back(at);
+        }
+
+        // Summing the original edges in path order gives the same distance a
+        // plain Dijkstra would report for this path
+        double cost = 0.0;
+        path.clear();
+        path.push_back(src);
+        for (std::size_t i = 0; i + 1 < hierarchyPath.size(); i++) {
+            UnpackEdge(hierarchyPath[i], hierarchyPath[i + 1], path, cost);
+        }
+        return cost;
+    }
 };
 
 CDijkstraPathRouter::CDijkstraPathRouter()
@@ -31,6 +366,8 @@ std::size_t CDijkstraPathRouter::VertexCount() const noexcept {
 CPathRouter::TVertexID CDijkstraPathRouter::AddVertex(std::any tag) noexcept {
     DImplementation->vertices.push_back(tag);
     DImplementation->adjacencyList.push_back(std::vector<Edge>());
+    DImplementation->reverseAdjacencyList.push_back(std::vector<Edge>());
+    DImplementation->hierarchyValid = false;
     return DImplementation->vertices.size() - 1;
 }
 
@@ -46,67 +383,41 @@ std::any CDijkstraPathRouter::GetVertexTag(TVertexID id) const noexcept {
 // Adds an edge from vertex src to vertex dest with the given weight.
 // If bidir is true, also adds the reverse edge from dest to src.
 // Returns false if src or dest is invalid or if weight is negative.
+// Any previously computed contraction hierarchy is discarded.
 bool CDijkstraPathRouter::AddEdge(TVertexID src, TVertexID dest, double weight, bool bidir) noexcept {
     if (src >= DImplementation->vertices.size() || dest >= DImplementation->vertices.size() || weight < 0) {
         return false;
     }
     DImplementation->adjacencyList[src].push_back({dest, weight});
+    DImplementation->reverseAdjacencyList[dest].push_back({src, weight});
     if (bidir) {
         DImplementation->adjacencyList[dest].push_back({src, weight});
+        DImplementation->reverseAdjacencyList[src].push_back({dest, weight});
     }
+    DImplementation->hierarchyValid = false;
     return true;
 }
 
+// Builds a contraction hierarchy over the current graph. Returns false if the
+// deadline passes before the hierarchy is complete, in which case queries
+// keep using the plain Dijkstra search.
 bool CDijkstraPathRouter::Precompute(std::chrono::steady_clock::time_point deadline) noexcept {
-    return true;
+    return DImplementation->BuildHierarchy(deadline);
 }
 
 // Returns the path distance of the path from src to dest, and fills out path 
 // with vertices. If no path exists NoPathExists is returned. 
+// Uses the contraction hierarchy when one is built, otherwise a
+// bidirectional Dijkstra search.
 double CDijkstraPathRouter::FindShortestPath(TVertexID src, TVertexID dest, std::vector<TVertexID>& path) noexcept {
     std::size_t n = DImplementation->vertices.size();
     if (src >= n || dest >= n) {
         return CPathRouter::NoPathExists;
     }
-
-    std::vector<double> dist(n, std::numeric_limits<double>::max());
-    std::vector<TVertexID> prev(n, CPathRouter::InvalidVertexID);
-
-    using Pair = std::pair<double, TVertexID>;
-    std::priority_queue<Pair, std::vector<Pair>, std::greater<Pair>> pq; // make the priority a min-heap, i.e. samllest element on top 
-
-    dist[src] = 0.0;
-    pq.push({0.0, src});
-    while (!pq.empty()) {
-        auto [d, u] = pq.top(); // dist to the vertex, vertex 
-        pq.pop();
-
-        if (d > dist[u]) continue;
-
-        if (u == dest) break;
-        
-        // push neighbors into the pq 
-        for (const auto& edge : DImplementation->adjacencyList[u]) {
-            TVertexID v = edge.dest;
-            double alt = d + edge.weight;
-            if (alt < dist[v]) {
-                dist[v] = alt;
-                prev[v] = u;
-                pq.push({alt, v});
-            }
-        }
+    path.clear();
+    if (DImplementation->hierarchyValid) {
+        return DImplementation->FindHierarchyPath(src, dest, path);
     }
-    // If can't reachdestination , return NoPathExists.
-    if (dist[dest] == std::numeric_limits<double>::max()) {
-        return CPathRouter::NoPathExists;
-    }
-    
-    // Reconstruct path using the prev
-    for (TVertexID at = dest; at != CPathRouter::InvalidVertexID; at = prev[at]) {
-        path.push_back(at);
-    }
-    // reverse to correct order 
-    std::reverse(path.begin(), path.end());
-    
-    return dist[dest];
-}
\ No newline at end of file
+
+    return DImplementation->FindBidirectionalPath(src, dest, path);
+}
@@ -1,8 +1,10 @@
 #include "TransportationPlanner.h"
 #include "TransportationPlannerConfig.h"
 #include "DijkstraTransportationPlanner.h"
-#include "BusSystemIndexer.h"
+#include "SearchWorkspace.h"
 #include <vector>
+#include <array>
+#include <cstdint>
 #include <queue>
 #include <unordered_map>
 #include <limits>
@@ -10,21 +12,402 @@
 #include <algorithm>
 #include <sstream>
 #include <memory>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "GeographicUtils.h"
 
+// Node restored from a planner snapshot. Snapshots keep only the ID and
+// location of each node, so no attributes are available.
+struct SSnapshotNode : public CStreetMap::SNode {
+    CStreetMap::TNodeID DID;
+    CStreetMap::TLocation DLocation;
+
+    SSnapshotNode(CStreetMap::TNodeID id, CStreetMap::TLocation location) : DID(id), DLocation(location) {
+    }
+
+    CStreetMap::TNodeID ID() const noexcept override {
+        return DID;
+    }
+
+    CStreetMap::TLocation Location() const noexcept override {
+        return DLocation;
+    }
+
+    std::size_t AttributeCount() const noexcept override {
+        return 0;
+    }
+
+    std::string GetAttributeKey(std::size_t) const noexcept override {
+        return "";
+    }
+
+    bool HasAttribute(const std::string &) const noexcept override {
+        return false;
+    }
+
+    std::string GetAttribute(const std::string &) const noexcept override {
+        return "";
+    }
+};
+
+// Snapshot files are a fixed header followed by arrays, each stored as a
+// 64 bit element count and the raw elements padded to 8 bytes. Bump
+// SnapshotVersion whenever the layout or any stored structure changes.
+class CSnapshotWriter {
+    private:
+        std::ofstream DOutput;
+
+        void Pad(std::size_t size) {
+            static const char Zeros[8] = {0};
+            if (size % 8)
+                DOutput.write(Zeros, 8 - size % 8);
+        }
+
+    public:
+        CSnapshotWriter(const std::string &filename) : DOutput(filename, std::ios::binary | std::ios::trunc) {
+        }
+
+        bool Valid() const {
+            return bool(DOutput);
+        }
+
+        template <typename T>
+        void Value(const T &value) {
+            DOutput.write(reinterpret_cast<const char *>(&value), sizeof(T));
+            Pad(sizeof(T));
+        }
+
+        template <typename T>
+        void Array(const std::vector<T> &values) {
+            Value(static_cast<uint64_t>(values.size()));
+            DOutput.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+            Pad(values.size() * sizeof(T));
+        }
+};
+
+// Reads a snapshot through a read only memory mapping of the whole file.
+// Any read past the end marks the reader invalid instead of throwing.
+class CSnapshotReader {
+    private:
+        const char *DData = nullptr;
+        std::size_t DSize = 0;
+        std::size_t DOffset = 0;
+        bool DValid = false;
+
+        static std::size_t Padded(std::size_t size) {
+            return (size + 7) / 8 * 8;
+        }
+
+    public:
+        CSnapshotReader(const std::string &filename) {
+            int FileDescriptor = open(filename.c_str(), O_RDONLY);
+            if (FileDescriptor < 0)
+                return;
+            struct stat FileStat;
+            if (fstat(FileDescriptor, &FileStat) == 0 && FileStat.st_size > 0) {
+                void *Mapping = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+                if (Mapping != MAP_FAILED) {
+                    DData = static_cast<const char *>(Mapping);
+                    DSize = FileStat.st_size;
+                    DValid = true;
+                }
+            }
+            close(FileDescriptor);
+        }
+
+        ~CSnapshotReader() {
+            if (DData)
+                munmap(const_cast<char *>(DData), DSize);
+        }
+
+        CSnapshotReader(const CSnapshotReader &) = delete;
+        CSnapshotReader &operator=(const CSnapshotReader &) = delete;
+
+        bool Valid() const {
+            return DValid;
+        }
+
+        bool AtEnd() const {
+            return DOffset == DSize;
+        }
+
+        template <typename T>
+        void Value(T &value) {
+            if (!DValid || DSize - DOffset < Padded(sizeof(T))) {
+                DValid = false;
+                return;
+            }
+            std::memcpy(&value, DData + DOffset, sizeof(T));
+            DOffset += Padded(sizeof(T));
+        }
+
+        template <typename T>
+        void Array(std::vector<T> &values) {
+            uint64_t Count = 0;
+            Value(Count);
+            if (!DValid || Count > (DSize - DOffset) / sizeof(T) || DSize - DOffset < Padded(Count * sizeof(T))) {
+                DValid = false;
+                return;
+            }
+            values.resize(Count);
+            std::memcpy(values.data(), DData + DOffset, Count * sizeof(T));
+            DOffset += Padded(Count * sizeof(T));
+        }
+};
+
 
 struct CDijkstraTransportationPlanner::SImplementation {
+    static constexpr uint32_t InvalidIndex32 = std::numeric_limits<uint32_t>::max();
+    // Search tags below this mark plain edges, mode switches (0) and bus
+    // rides (1); contracted street edges add the chain reference to it
+    static constexpr int ChainTag = 2;
+
+    // Edge under construction. Edges of contracted graphs follow a chain of
+    // way segments, chain is the chain index times two plus one when the
+    // chain is followed backwards.
+    struct SEdge {
+        std::size_t target;
+        double weight;
+        uint32_t chain = InvalidIndex32;
+    };
+    using TAdjacencyList = std::vector<std::vector<SEdge>>;
+
+    // Frozen compressed sparse row graph. The edges leaving node u are
+    // targets/weights[offsets[u]] up to (but excluding) offsets[u + 1].
+    // Weights stay double so path costs match a sum of the original edges.
+    // Contracted graphs also record the chain each edge follows, the weight
+    // of every chain segment (numbered as in the planner's chain table) and
+    // which ways each chain may be followed, bit 0 forward and bit 1
+    // backward; searches add up the segment weights one at a time.
+    struct SCompactGraph {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<double> weights;
+        std::vector<uint32_t> edgeChains;
+        std::vector<double> segmentWeights;
+        std::vector<uint8_t> chainDirections;
+
+        static SCompactGraph Freeze(const TAdjacencyList &adjacency) {
+            SCompactGraph graph;
+            std::size_t edgeCount = 0;
+            for (auto &edges : adjacency)
+                edgeCount += edges.size();
+            graph.offsets.reserve(adjacency.size() + 1);
+            graph.targets.reserve(edgeCount);
+            graph.weights.reserve(edgeCount);
+            graph.offsets.push_back(0);
+            for (auto &edges : adjacency) {
+                for (auto &edge : edges) {
+                    graph.targets.push_back(static_cast<uint32_t>(edge.target));
+                    graph.weights.push_back(edge.weight);
+                    if (edge.chain != InvalidIndex32)
+                        graph.edgeChains.push_back(edge.chain);
+                }
+                graph.offsets.push_back(static_cast<uint32_t>(graph.targets.size()));
+            }
+            return graph;
+        }
+
+        bool Contracted() const {
+            return !edgeChains.empty();
+        }
+
+        uint32_t EdgeBegin(std::size_t node) const {
+            return offsets[node];
+        }
+
+        uint32_t EdgeEnd(std::size_t node) const {
+            return offsets[node + 1];
+        }
+
+        void Write(CSnapshotWriter &writer) const {
+            writer.Array(offsets);
+            writer.Array(targets);
+            writer.Array(weights);
+            writer.Array(edgeChains);
+            writer.Array(segmentWeights);
+            writer.Array(chainDirections);
+        }
+
+        // Rejects graphs whose offsets, targets or chains would index out of
+        // range
+        bool Read(CSnapshotReader &reader, std::size_t nodeCount, std::size_t chainCount, std::size_t segmentCount) {
+            reader.Array(offsets);
+            reader.Array(targets);
+            reader.Array(weights);
+            reader.Array(edgeChains);
+            reader.Array(segmentWeights);
+            reader.Array(chainDirections);
+            if (!reader.Valid())
+                return false;
+            if (offsets.empty()) // a graph that was never built
+                return targets.empty() && weights.empty() && edgeChains.empty() && segmentWeights.empty() && chainDirections.empty();
+            if (chainCount ? edgeChains.size() != targets.size() || segmentWeights.size() != segmentCount || chainDirections.size() != chainCount
+                           : !edgeChains.empty() || !segmentWeights.empty() || !chainDirections.empty())
+                return false;
+            if (!std::all_of(edgeChains.begin(), edgeChains.end(), [chainCount](uint32_t chain) { return chain / 2 < chainCount; }))
+                return false;
+            if (offsets.size() != nodeCount + 1 || offsets.front() != 0 || offsets.back() != targets.size() || weights.size() != targets.size())
+                return false;
+            if (!std::is_sorted(offsets.begin(), offsets.end()))
+                return false;
+            return std::all_of(targets.begin(), targets.end(), [nodeCount](uint32_t target) { return target < nodeCount; });
+        }
+
+        std::size_t NodeCount() const {
+            return offsets.empty() ? 0 : offsets.size() - 1;
+        }
+
+        // Graph with every edge flipped, for searches toward a target.
+        // Flipped edges follow their chain the other way.
+        SCompactGraph Reverse() const {
+            TAdjacencyList adjacency(NodeCount());
+            for (std::size_t u = 0; u < NodeCount(); u++) {
+                for (uint32_t e = EdgeBegin(u); e < EdgeEnd(u); e++)
+                    adjacency[targets[e]].push_back({u, weights[e], Contracted() ? edgeChains[e] ^ 1 : InvalidIndex32});
+            }
+            SCompactGraph graph = Freeze(adjacency);
+            graph.segmentWeights = segmentWeights;
+            for (auto directions : chainDirections)
+                graph.chainDirections.push_back(static_cast<uint8_t>((directions & 1) << 1 | (directions & 2) >> 1));
+            return graph;
+        }
+    };
+
+    // ALT (A*, landmarks, triangle inequality) distance tables. Distances
+    // are stored node major so a heuristic evaluation reads one contiguous
+    // run; unreachable entries are infinity so the bound arithmetic prunes
+    // nodes that provably cannot reach the target.
+    struct SLandmarkTable {
+        std::size_t landmarkCount = 0;
+        std::vector<std::size_t> landmarks;
+        std::vector<double> fromLandmark; // [node * landmarkCount + k] = d(landmark k, node)
+        std::vector<double> toLandmark;   // [node * landmarkCount + k] = d(node, landmark k)
+
+        // Lower bound on d(node, target) from the triangle inequality
+        double Bound(std::size_t node, std::size_t target) const {
+            double bound = 0.0;
+            const double *nodeFrom = fromLandmark.data() + node * landmarkCount;
+            const double *nodeTo = toLandmark.data() + node * landmarkCount;
+            const double *targetFrom = fromLandmark.data() + target * landmarkCount;
+            const double *targetTo = toLandmark.data() + target * landmarkCount;
+            for (std::size_t k = 0; k < landmarkCount; k++) {
+                bound = std::max(bound, targetFrom[k] - nodeFrom[k]);
+                bound = std::max(bound, nodeTo[k] - targetTo[k]);
+            }
+            return bound;
+        }
+
+        void Write(CSnapshotWriter &writer) const {
+            writer.Value(static_cast<uint64_t>(landmarkCount));
+            std::vector<uint64_t> storedLandmarks(landmarks.begin(), landmarks.end());
+            writer.Array(storedLandmarks);
+            writer.Array(fromLandmark);
+            writer.Array(toLandmark);
+        }
+
+        bool Read(CSnapshotReader &reader, std::size_t nodeCount) {
+            uint64_t storedCount = 0;
+            std::vector<uint64_t> storedLandmarks;
+            reader.Value(storedCount);
+            reader.Array(storedLandmarks);
+            reader.Array(fromLandmark);
+            reader.Array(toLandmark);
+            landmarkCount = storedCount;
+            landmarks.assign(storedLandmarks.begin(), storedLandmarks.end());
+            return reader.Valid() && landmarks.size() == landmarkCount &&
+                   fromLandmark.size() == nodeCount * landmarkCount && toLandmark.size() == nodeCount * landmarkCount;
+        }
+    };
+
+    static constexpr char SnapshotMagic[8] = {'T', 'P', 'S', 'N', 'A', 'P', '\0', '\0'};
+    static constexpr uint32_t SnapshotVersion = 3;
+    static constexpr uint32_t SnapshotByteOrder = 0x01020304;
+
+    // A query endpoint as a search vertex. With contracted graphs a shape
+    // point is not a vertex, it becomes a virtual one (numbered after the
+    // real vertices) at its position along its chain. A node in no way also
+    // becomes a virtual vertex, one with no chain and so no edges.
+    struct SEndpoint {
+        std::size_t node;
+        std::size_t vertex;
+        bool shape = false;
+        uint32_t chain = InvalidIndex32;
+        uint32_t position = 0; // index of node in the chain's node list
+    };
+
+    // Extra edge between a virtual endpoint and the chain it lies on
+    struct SOverlayEdge {
+        std::size_t from;
+        std::size_t to;
+        uint32_t chain;
+    };
+
     std::shared_ptr<SConfiguration> the_config;
-    std::vector<std::shared_ptr<CStreetMap::SNode>> sortedNodes;
-    std::unordered_map<TNodeID, std::size_t> nodeIndexMap;
-    std::vector<std::vector<std::pair<std::size_t, double>>> graphDriving;
-    std::vector<std::vector<std::pair<std::size_t, double>>> graphWalking;
-    std::vector<std::vector<std::pair<std::size_t, double>>> graphBiking;
-    std::unique_ptr<CBusSystemIndexer> busIndexer;
-
-    SImplementation(std::shared_ptr<SConfiguration> config) : the_config(config) {
+    std::vector<std::shared_ptr<CStreetMap::SNode>> sortedNodes; // empty when loaded from a snapshot
+    std::vector<TNodeID> sortedNodeIDs;
+    std::vector<CStreetMap::TLocation> nodeLocations;
+    std::vector<std::array<double, 3>> nodeUnitVectors; // position on the unit sphere, for cheap distance bounds
+    // Contracted graphs only keep way endpoints, intersections and bus stop
+    // nodes as vertices, vertex v being node vertexNodes[v]. Chain c is the
+    // run of way segments through the nodes chainNodes[chainOffsets[c]] up
+    // to (but excluding) chainOffsets[c + 1], from one vertex to the next
+    // with only shape points in between; its segments are numbered from
+    // chainOffsets[c] - c. All three are empty when every node is a vertex.
+    std::vector<uint32_t> vertexNodes;
+    std::vector<uint32_t> chainOffsets;
+    std::vector<uint32_t> chainNodes;
+    // Derived from the above: the vertex of each node, or for other nodes
+    // InvalidIndex32 and the chain they lie on (InvalidIndex32 if none)
+    std::vector<uint32_t> nodeVertices;
+    std::vector<uint32_t> nodeChains;
+    SCompactGraph graphDriving;
+    SCompactGraph graphDrivingReverse; // only built for bidirectional searches
+    SCompactGraph graphWalking;
+    SCompactGraph graphBiking;
+    double maxDrivingSpeed = 0.0; // fastest speed on any driving edge, bounds the A* heuristic
+    // Transit routes as contiguous stop arrays for the round based search.
+    // Route r visits the nodes routeStops[routeOffsets[r]] up to (but
+    // excluding) routeStops[routeOffsets[r + 1]]; routeDistances holds the
+    // distance along the route from its first stop to each of them.
+    std::vector<uint32_t> routeOffsets;
+    std::vector<uint32_t> routeStops;
+    std::vector<double> routeDistances;
+    // Positions in routeStops where each node is visited, CSR by node
+    std::vector<uint32_t> stopVisitOffsets;
+    std::vector<uint32_t> stopVisits;
+    SLandmarkTable landmarksDriving;
+    SLandmarkTable landmarksWalkBike; // walking and biking edges combined, modes can be switched freely
+
+    static constexpr std::size_t MaxLandmarkCount = 16;
+
+    // Per-thread search state, reused across queries
+    static CSearchWorkspace &QueryWorkspace() {
+        static thread_local CSearchWorkspace workspace;
+        return workspace;
+    }
+
+    static CSearchWorkspace &ReverseQueryWorkspace() {
+        static thread_local CSearchWorkspace workspace;
+        return workspace;
+    }
+
+    SImplementation(std::shared_ptr<SConfiguration> config, bool build = true) : the_config(config) {
+        if (!build)
+            return;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(the_config->PrecomputeTime());
         buildGraphs();
-        busIndexer = std::make_unique<CBusSystemIndexer>(the_config->BusSystem());
+        buildTransitRoutes();
+        if (the_config->SearchAlgorithm() == ESearchAlgorithm::ALT)
+            precomputeLandmarks(deadline);
+        if (the_config->SearchAlgorithm() == ESearchAlgorithm::Bidirectional)
+            graphDrivingReverse = graphDriving.Reverse();
     }
 
     void buildGraphs() {
@@ -36,25 +419,104 @@ struct CDijkstraTransportationPlanner::SImplementation {
         }
         std::sort(sortedNodes.begin(), sortedNodes.end(),
                   [](const auto &a, const auto &b) { return a->ID() < b->ID(); });
-        for (std::size_t i = 0; i < sortedNodes.size(); i++)
+        std::unordered_map<TNodeID, std::size_t> nodeIndexMap;
+        for (std::size_t i = 0; i < sortedNodes.size(); i++) {
             nodeIndexMap[sortedNodes[i]->ID()] = i;
+            sortedNodeIDs.push_back(sortedNodes[i]->ID());
+            nodeLocations.push_back(sortedNodes[i]->Location());
+            double lat = SGeographicUtils::DegreesToRadians(nodeLocations[i].first);
+            double lon = SGeographicUtils::DegreesToRadians(nodeLocations[i].second);
+            nodeUnitVectors.push_back({std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat)});
+        }
+
+        // Contracted graphs number their vertices in node order
+        bool contract = the_config->ContractGraphs() && !sortedNodeIDs.empty();
+        std::vector<bool> isVertex;
+        if (contract) {
+            isVertex = findVertices(nodeIndexMap);
+            nodeVertices.assign(sortedNodeIDs.size(), InvalidIndex32);
+            for (std::size_t i = 0; i < sortedNodeIDs.size(); i++) {
+                if (isVertex[i]) {
+                    nodeVertices[i] = static_cast<uint32_t>(vertexNodes.size());
+                    vertexNodes.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            chainOffsets.push_back(0);
+        }
+
+        TAdjacencyList adjDriving(vertexCount());
+        TAdjacencyList adjWalking(vertexCount());
+        TAdjacencyList adjBiking(vertexCount());
+        // Per mode weight of every chain segment and the directions each
+        // chain may be followed in
+        std::vector<double> segmentsDriving, segmentsWalking, segmentsBiking;
+        std::vector<uint8_t> directionsDriving, directionsWalking, directionsBiking;
+
+        // Adds the edges following the chain just completed, both ways
+        // unless the mode may only follow it forward or not at all
+        auto closeChain = [&](bool oneWay, bool bicycleAllowed) {
+            uint32_t chain = static_cast<uint32_t>(chainOffsets.size() - 1);
+            chainOffsets.push_back(static_cast<uint32_t>(chainNodes.size()));
+            std::size_t first = nodeVertices[chainNode(chain * 2, 0)];
+            std::size_t last = nodeVertices[chainNode(chain * 2 + 1, 0)];
+            auto addEdges = [&](TAdjacencyList &adjacency, const std::vector<double> &segments, std::vector<uint8_t> &directions, uint8_t allowed) {
+                directions.push_back(allowed);
+                if (allowed & 1)
+                    adjacency[first].push_back({last, foldChain(segments, chain * 2, 0, chainSegments(chain), 0.0), chain * 2});
+                if (allowed & 2)
+                    adjacency[last].push_back({first, foldChain(segments, chain * 2 + 1, 0, chainSegments(chain), 0.0), chain * 2 + 1});
+            };
+            addEdges(adjWalking, segmentsWalking, directionsWalking, 3);
+            addEdges(adjDriving, segmentsDriving, directionsDriving, oneWay ? 1 : 3);
+            addEdges(adjBiking, segmentsBiking, directionsBiking, !bicycleAllowed ? 0 : oneWay ? 1 : 3);
+        };
 
-        graphDriving.resize(sortedNodes.size());
-        graphWalking.resize(sortedNodes.size());
-        graphBiking.resize(sortedNodes.size());
+        // Interned attribute IDs let each way be checked with integer
+        // compares; a key without an ID means the map does not intern, or
+        // that no way carries it, and the string accessors handle both
+        const CStreetMap::TAttributeID invalidID = CStreetMap::InvalidAttributeID;
+        CStreetMap::TAttributeID onewayKey = streetMap->AttributeID("oneway");
+        CStreetMap::TAttributeID bicycleKey = streetMap->AttributeID("bicycle");
+        CStreetMap::TAttributeID maxspeedKey = streetMap->AttributeID("maxspeed");
+        CStreetMap::TAttributeID yesValue = streetMap->AttributeID("yes");
+        CStreetMap::TAttributeID noValue = streetMap->AttributeID("no");
+        std::unordered_map<CStreetMap::TAttributeID, double> speedByValue;
 
         std::size_t wCount = streetMap->WayCount();
         for (std::size_t i = 0; i < wCount; i++) {
             auto way = streetMap->WayByIndex(i);
             std::size_t numNodes = way->NodeCount();
             bool oneWay = false;
-            if (way->HasAttribute("oneway") && way->GetAttribute("oneway") == "yes")
+            if (onewayKey != invalidID) {
+                CStreetMap::TAttributeID value = way->GetAttributeID(onewayKey);
+                oneWay = value != invalidID && value == yesValue;
+            }
+            else if (way->HasAttribute("oneway") && way->GetAttribute("oneway") == "yes")
                 oneWay = true;
             bool bicycleAllowed = true;
-            if (way->HasAttribute("bicycle") && way->GetAttribute("bicycle") == "no")
+            if (bicycleKey != invalidID) {
+                CStreetMap::TAttributeID value = way->GetAttributeID(bicycleKey);
+                bicycleAllowed = value == invalidID || value != noValue;
+            }
+            else if (way->HasAttribute("bicycle") && way->GetAttribute("bicycle") == "no")
                 bicycleAllowed = false;
             double effectiveSpeed = the_config->DefaultSpeedLimit();
-            if (way->HasAttribute("maxspeed")) {
+            CStreetMap::TAttributeID speedValue = maxspeedKey != invalidID ? way->GetAttributeID(maxspeedKey) : invalidID;
+            if (speedValue != invalidID) {
+                // Parse each distinct speed string once
+                auto cached = speedByValue.find(speedValue);
+                if (cached == speedByValue.end()) {
+                    double speed = effectiveSpeed;
+                    try {
+                        speed = std::stod(way->GetAttribute("maxspeed"));
+                    }
+                    catch (...) {
+                    }
+                    cached = speedByValue.emplace(speedValue, speed).first;
+                }
+                effectiveSpeed = cached->second;
+            }
+            else if (maxspeedKey == invalidID && way->HasAttribute("maxspeed")) {
                 try {
                     effectiveSpeed = std::stod(way->GetAttribute("maxspeed"));
                 }
@@ -69,35 +531,322 @@ struct CDijkstraTransportationPlanner::SImplementation {
                     continue;
                 std::size_t idx1 = nodeIndexMap[id1];
                 std::size_t idx2 = nodeIndexMap[id2];
-                double dist = SGeographicUtils::HaversineDistanceInMiles(sortedNodes[idx1]->Location(), sortedNodes[idx2]->Location());
-                graphWalking[idx1].push_back({idx2, dist / the_config->WalkSpeed()});
-                graphWalking[idx2].push_back({idx1, dist / the_config->WalkSpeed()});
+                double dist = SGeographicUtils::HaversineDistanceInMiles(nodeLocations[idx1], nodeLocations[idx2]);
+                maxDrivingSpeed = std::max(maxDrivingSpeed, effectiveSpeed);
+                if (contract) {
+                    // Segments extend the open chain until it reaches a
+                    // vertex; runs of the way always start at one
+                    if (chainNodes.size() == chainOffsets.back())
+                        chainNodes.push_back(static_cast<uint32_t>(idx1));
+                    chainNodes.push_back(static_cast<uint32_t>(idx2));
+                    segmentsWalking.push_back(dist / the_config->WalkSpeed());
+                    segmentsDriving.push_back(dist / effectiveSpeed);
+                    segmentsBiking.push_back(dist / the_config->BikeSpeed());
+                    if (isVertex[idx2])
+                        closeChain(oneWay, bicycleAllowed);
+                    continue;
+                }
+                adjWalking[idx1].push_back({idx2, dist / the_config->WalkSpeed()});
+                adjWalking[idx2].push_back({idx1, dist / the_config->WalkSpeed()});
                 if (oneWay)
-                    graphDriving[idx1].push_back({idx2, dist / effectiveSpeed});
+                    adjDriving[idx1].push_back({idx2, dist / effectiveSpeed});
                 else {
-                    graphDriving[idx1].push_back({idx2, dist / effectiveSpeed});
-                    graphDriving[idx2].push_back({idx1, dist / effectiveSpeed});
+                    adjDriving[idx1].push_back({idx2, dist / effectiveSpeed});
+                    adjDriving[idx2].push_back({idx1, dist / effectiveSpeed});
                 }
                 if (bicycleAllowed) {
                     if (oneWay)
-                        graphBiking[idx1].push_back({idx2, dist / the_config->BikeSpeed()});
+                        adjBiking[idx1].push_back({idx2, dist / the_config->BikeSpeed()});
                     else {
-                        graphBiking[idx1].push_back({idx2, dist / the_config->BikeSpeed()});
-                        graphBiking[idx2].push_back({idx1, dist / the_config->BikeSpeed()});
+                        adjBiking[idx1].push_back({idx2, dist / the_config->BikeSpeed()});
+                        adjBiking[idx2].push_back({idx1, dist / the_config->BikeSpeed()});
                     }
                 }
             }
         }
+        graphDriving = SCompactGraph::Freeze(adjDriving);
+        graphWalking = SCompactGraph::Freeze(adjWalking);
+        graphBiking = SCompactGraph::Freeze(adjBiking);
+        if (contract) {
+            graphDriving.segmentWeights = std::move(segmentsDriving);
+            graphDriving.chainDirections = std::move(directionsDriving);
+            graphWalking.segmentWeights = std::move(segmentsWalking);
+            graphWalking.chainDirections = std::move(directionsWalking);
+            graphBiking.segmentWeights = std::move(segmentsBiking);
+            graphBiking.chainDirections = std::move(directionsBiking);
+            indexChains();
+        }
     }
 
-    double dijkstraDriving(TNodeID srcID, TNodeID destID, std::vector<std::size_t> &pathIndices) {
-        if (nodeIndexMap.find(srcID) == nodeIndexMap.end() ||
-            nodeIndexMap.find(destID) == nodeIndexMap.end())
-            return std::numeric_limits<double>::max();
-        std::size_t src = nodeIndexMap[srcID];
-        std::size_t dest = nodeIndexMap[destID];
-        std::vector<double> dist(sortedNodes.size(), std::numeric_limits<double>::max());
-        std::vector<int> prev(sortedNodes.size(), -1);
+    // Nodes that stay vertices of contracted graphs: the ends of every run
+    // of a way's nodes present in the map (way endpoints, or where a missing
+    // node breaks the way), nodes referenced more than once, which covers
+    // intersections, and bus stop nodes. Other nodes are either shape points
+    // inside a single run or in no way at all, and are dropped.
+    std::vector<bool> findVertices(const std::unordered_map<TNodeID, std::size_t> &nodeIndexMap) const {
+        auto streetMap = the_config->StreetMap();
+        std::vector<bool> isVertex(sortedNodeIDs.size(), false);
+        std::vector<uint8_t> references(sortedNodeIDs.size(), 0);
+        for (std::size_t i = 0; i < streetMap->WayCount(); i++) {
+            auto way = streetMap->WayByIndex(i);
+            std::size_t runLength = 0;
+            std::size_t previous = 0;
+            for (std::size_t j = 0; j <= way->NodeCount(); j++) {
+                auto search = j < way->NodeCount() ? nodeIndexMap.find(way->GetNodeID(j)) : nodeIndexMap.end();
+                if (search == nodeIndexMap.end()) {
+                    if (runLength)
+                        isVertex[previous] = true;
+                    runLength = 0;
+                    continue;
+                }
+                if (!runLength)
+                    isVertex[search->second] = true;
+                references[search->second] = std::min(references[search->second] + 1, 2);
+                previous = search->second;
+                runLength++;
+            }
+        }
+        for (std::size_t i = 0; i < sortedNodeIDs.size(); i++) {
+            if (references[i] > 1)
+                isVertex[i] = true;
+        }
+        auto busSystem = the_config->BusSystem();
+        for (std::size_t i = 0; busSystem && i < busSystem->StopCount(); i++) {
+            auto stop = busSystem->StopByIndex(i);
+            std::size_t node;
+            if (stop && nodeIndex(stop->NodeID(), node))
+                isVertex[node] = true;
+        }
+        return isVertex;
+    }
+
+    // Fills nodeVertices and nodeChains from vertexNodes and the chains
+    void indexChains() {
+        nodeVertices.assign(sortedNodeIDs.size(), InvalidIndex32);
+        nodeChains.assign(sortedNodeIDs.size(), InvalidIndex32);
+        for (std::size_t v = 0; v < vertexNodes.size(); v++)
+            nodeVertices[vertexNodes[v]] = static_cast<uint32_t>(v);
+        for (uint32_t chain = 0; chain + 1 < chainOffsets.size(); chain++) {
+            for (uint32_t position = 1; position < chainSegments(chain); position++)
+                nodeChains[chainNode(chain * 2, position)] = chain;
+        }
+    }
+
+    std::size_t vertexCount() const {
+        return vertexNodes.empty() ? sortedNodeIDs.size() : vertexNodes.size();
+    }
+
+    // Entries of a search: the vertices, and with contracted graphs two
+    // more for the virtual endpoints
+    std::size_t searchSize() const {
+        return vertexNodes.empty() ? sortedNodeIDs.size() : vertexNodes.size() + 2;
+    }
+
+    uint32_t chainSegments(uint32_t chain) const {
+        return chainOffsets[chain + 1] - chainOffsets[chain] - 1;
+    }
+
+    // Position of a chain node counted in the direction chain reference ref
+    // (chain index times two, plus one for backwards) follows the chain
+    uint32_t traversalPosition(uint32_t ref, uint32_t position) const {
+        return ref % 2 ? chainSegments(ref / 2) - position : position;
+    }
+
+    std::size_t chainNode(uint32_t ref, uint32_t position) const {
+        return chainNodes[chainOffsets[ref / 2] + traversalPosition(ref, position)];
+    }
+
+    // Adds the weights of the segments between positions first and last
+    // along chain reference ref to distance, one at a time and in order so
+    // the result matches a search over the uncontracted graph
+    double foldChain(const std::vector<double> &weights, uint32_t ref, uint32_t first, uint32_t last, double distance) const {
+        uint32_t chain = ref / 2;
+        const double *segments = weights.data() + chainOffsets[chain] - chain;
+        if (ref % 2 == 0) {
+            for (uint32_t position = first; position < last; position++)
+                distance += segments[position];
+        }
+        else {
+            uint32_t count = chainSegments(chain);
+            for (uint32_t position = first; position < last; position++)
+                distance += segments[count - 1 - position];
+        }
+        return distance;
+    }
+
+    // Distance after following edge e of graph from distance
+    double extend(const SCompactGraph &graph, double distance, uint32_t e) const {
+        if (!graph.Contracted())
+            return distance + graph.weights[e];
+        uint32_t ref = graph.edgeChains[e];
+        return foldChain(graph.segmentWeights, ref, 0, chainSegments(ref / 2), distance);
+    }
+
+    // Index of id in the sorted node order
+    bool nodeIndex(TNodeID id, std::size_t &index) const {
+        auto search = std::lower_bound(sortedNodeIDs.begin(), sortedNodeIDs.end(), id);
+        if (search == sortedNodeIDs.end() || *search != id)
+            return false;
+        index = search - sortedNodeIDs.begin();
+        return true;
+    }
+
+    // Endpoint for node, a shape point taking virtualVertex
+    SEndpoint endpoint(std::size_t node, std::size_t virtualVertex) const {
+        SEndpoint result;
+        result.node = node;
+        result.vertex = node;
+        if (vertexNodes.empty() || nodeVertices[node] != InvalidIndex32) {
+            result.vertex = vertexNodes.empty() ? node : nodeVertices[node];
+            return result;
+        }
+        result.vertex = virtualVertex;
+        result.shape = true;
+        result.chain = nodeChains[node];
+        if (result.chain == InvalidIndex32)
+            return result;
+        auto begin = chainNodes.begin() + chainOffsets[result.chain];
+        result.position = static_cast<uint32_t>(std::find(begin, chainNodes.begin() + chainOffsets[result.chain + 1], node) - begin);
+        return result;
+    }
+
+    // Resolves the node IDs of a query to search endpoints. A query from a
+    // node to itself uses one endpoint for both ends.
+    bool resolveQuery(TNodeID srcID, TNodeID destID, SEndpoint &src, SEndpoint &dest) const {
+        std::size_t srcNode, destNode;
+        if (!nodeIndex(srcID, srcNode) || !nodeIndex(destID, destNode))
+            return false;
+        src = endpoint(srcNode, vertexCount());
+        dest = destNode == srcNode ? src : endpoint(destNode, vertexCount() + 1);
+        return true;
+    }
+
+    // Node of search vertex v in a query between src and dest
+    std::size_t searchNode(std::size_t v, const SEndpoint &src, const SEndpoint &dest) const {
+        if (vertexNodes.empty())
+            return v;
+        if (v < vertexNodes.size())
+            return vertexNodes[v];
+        return v == src.vertex ? src.node : dest.node;
+    }
+
+    // Edges of graph out of a virtual endpoint from to the ends of its chain
+    // (or straight to to on the same chain), and into a virtual endpoint to
+    // from the ends of its chain
+    void overlayEdges(const SCompactGraph &graph, const SEndpoint &from, const SEndpoint &to, std::vector<SOverlayEdge> &edges) const {
+        edges.clear();
+        for (uint32_t direction = 0; direction < 2; direction++) {
+            if (from.shape && from.chain != InvalidIndex32 && graph.chainDirections[from.chain] >> direction & 1) {
+                uint32_t ref = from.chain * 2 + direction;
+                edges.push_back({from.vertex, nodeVertices[chainNode(ref, chainSegments(from.chain))], ref});
+                if (to.shape && to.vertex != from.vertex && to.chain == from.chain &&
+                    traversalPosition(ref, from.position) < traversalPosition(ref, to.position))
+                    edges.push_back({from.vertex, to.vertex, ref});
+            }
+            if (to.shape && to.chain != InvalidIndex32 && to.vertex != from.vertex && graph.chainDirections[to.chain] >> direction & 1) {
+                uint32_t ref = to.chain * 2 + direction;
+                edges.push_back({nodeVertices[chainNode(ref, 0)], to.vertex, ref});
+            }
+        }
+    }
+
+    // Positions along chain reference ref where a step from search vertex u
+    // to v starts and ends, virtual endpoints lying partway along
+    std::pair<uint32_t, uint32_t> stepRange(uint32_t ref, std::size_t u, std::size_t v, const SEndpoint &from, const SEndpoint &to) const {
+        uint32_t first = from.shape && u == from.vertex ? traversalPosition(ref, from.position) : 0;
+        uint32_t last = to.shape && v == to.vertex ? traversalPosition(ref, to.position) : chainSegments(ref / 2);
+        return {first, last};
+    }
+
+    // Calls visit(v, distance, tag) for every edge of graph and overlay
+    // leaving search vertex u at distance d, searching from from toward to.
+    // Tags are ChainTag plus the chain reference followed on contracted
+    // graphs and zero otherwise.
+    template <typename TVisit>
+    void forEachEdge(const SCompactGraph &graph, const std::vector<SOverlayEdge> &overlay, const SEndpoint &from, const SEndpoint &to,
+                     std::size_t u, double d, TVisit visit) const {
+        if (u < graph.NodeCount()) {
+            if (!graph.Contracted()) {
+                for (uint32_t e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++)
+                    visit(graph.targets[e], d + graph.weights[e], 0);
+            }
+            else {
+                for (uint32_t e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+                    uint32_t ref = graph.edgeChains[e];
+                    visit(graph.targets[e], foldChain(graph.segmentWeights, ref, 0, chainSegments(ref / 2), d), ChainTag + static_cast<int>(ref));
+                }
+            }
+        }
+        for (auto &edge : overlay) {
+            if (edge.from != u)
+                continue;
+            auto range = stepRange(edge.chain, u, edge.to, from, to);
+            visit(edge.to, foldChain(graph.segmentWeights, edge.chain, range.first, range.second, d), ChainTag + static_cast<int>(edge.chain));
+        }
+    }
+
+    // Appends the nodes passed on a step from search vertex u to v recorded
+    // with tag, ending with the node of v
+    void appendStep(int tag, std::size_t u, std::size_t v, const SEndpoint &src, const SEndpoint &dest, std::vector<std::size_t> &nodes) const {
+        if (tag >= ChainTag) {
+            uint32_t ref = static_cast<uint32_t>(tag - ChainTag);
+            auto range = stepRange(ref, u, v, src, dest);
+            for (uint32_t position = range.first + 1; position < range.second; position++)
+                nodes.push_back(chainNode(ref, position));
+        }
+        nodes.push_back(searchNode(v, src, dest));
+    }
+
+    // Resolves every route to the search vertices of its stops once, along
+    // with prefix sums of the distances between consecutive stops so any
+    // ride time is a difference of two entries. Stop nodes are always
+    // vertices, contracted or not.
+    void buildTransitRoutes() {
+        auto busSystem = the_config->BusSystem();
+        routeOffsets.push_back(0);
+        for (std::size_t i = 0; i < busSystem->RouteCount(); i++) {
+            auto route = busSystem->RouteByIndex(i);
+            if (!route)
+                continue;
+            std::size_t first = routeStops.size();
+            std::size_t previousNode = 0;
+            for (std::size_t j = 0; j < route->StopCount(); j++) {
+                auto stop = busSystem->StopByID(route->GetStopID(j));
+                if (!stop)
+                    continue;
+                std::size_t node;
+                if (!nodeIndex(stop->NodeID(), node))
+                    continue;
+                double distance = 0.0;
+                if (routeStops.size() > first)
+                    distance = routeDistances.back() + SGeographicUtils::HaversineDistanceInMiles(nodeLocations[previousNode], nodeLocations[node]);
+                previousNode = node;
+                routeStops.push_back(static_cast<uint32_t>(vertexNodes.empty() ? node : nodeVertices[node]));
+                routeDistances.push_back(distance);
+            }
+            if (routeStops.size() - first < 2) {
+                routeStops.resize(first);
+                routeDistances.resize(first);
+                continue;
+            }
+            routeOffsets.push_back(static_cast<uint32_t>(routeStops.size()));
+        }
+
+        stopVisitOffsets.assign(vertexCount() + 1, 0);
+        for (auto node : routeStops)
+            stopVisitOffsets[node + 1]++;
+        for (std::size_t u = 0; u < vertexCount(); u++)
+            stopVisitOffsets[u + 1] += stopVisitOffsets[u];
+        stopVisits.resize(routeStops.size());
+        std::vector<uint32_t> fill(stopVisitOffsets.begin(), stopVisitOffsets.end() - 1);
+        for (std::size_t position = 0; position < routeStops.size(); position++)
+            stopVisits[fill[routeStops[position]]++] = static_cast<uint32_t>(position);
+    }
+
+    // Fills dist with the distance from src to every vertex over the edges
+    // of all the graphs
+    void singleSourceDistances(const std::vector<const SCompactGraph *> &graphs, std::size_t src, std::vector<double> &dist) const {
+        dist.assign(graphs.front()->NodeCount(), std::numeric_limits<double>::infinity());
         using QueueItem = std::pair<double, std::size_t>;
         std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> pq;
         dist[src] = 0.0;
@@ -107,49 +856,287 @@ struct CDijkstraTransportationPlanner::SImplementation {
             pq.pop();
             if (d > dist[u])
                 continue;
-            if (u == dest)
+            for (const SCompactGraph *graph : graphs) {
+                for (uint32_t e = graph->EdgeBegin(u); e < graph->EdgeEnd(u); e++) {
+                    std::size_t v = graph->targets[e];
+                    double alt = extend(*graph, d, e);
+                    if (alt < dist[v]) {
+                        dist[v] = alt;
+                        pq.push({dist[v], v});
+                    }
+                }
+            }
+        }
+    }
+
+    // Picks landmarks by farthest-point selection over the union of graphs:
+    // each new landmark is the reachable vertex farthest from all landmarks
+    // chosen so far. Stops early if the deadline passes; the landmarks
+    // completed so far remain usable.
+    void buildLandmarks(const std::vector<const SCompactGraph *> &graphs, SLandmarkTable &table, std::chrono::steady_clock::time_point deadline) const {
+        std::size_t n = graphs.front()->NodeCount();
+        if (n == 0)
+            return;
+        std::vector<SCompactGraph> reversed;
+        for (const SCompactGraph *graph : graphs)
+            reversed.push_back(graph->Reverse());
+        std::vector<const SCompactGraph *> reverse;
+        for (auto &graph : reversed)
+            reverse.push_back(&graph);
+        std::vector<std::vector<double>> fromDists, toDists;
+        std::vector<double> nearest(n, std::numeric_limits<double>::infinity());
+        std::vector<double> dist;
+
+        // Seed with the node farthest from node 0 rather than node 0 itself
+        singleSourceDistances(graphs, 0, dist);
+        std::size_t next = 0;
+        for (std::size_t v = 0; v < n; v++) {
+            if (dist[v] != std::numeric_limits<double>::infinity() && dist[v] > dist[next])
+                next = v;
+        }
+        while (table.landmarks.size() < MaxLandmarkCount && std::chrono::steady_clock::now() < deadline) {
+            table.landmarks.push_back(next);
+            fromDists.emplace_back();
+            toDists.emplace_back();
+            singleSourceDistances(graphs, next, fromDists.back());
+            singleSourceDistances(reverse, next, toDists.back());
+
+            double farthest = 0.0;
+            for (std::size_t v = 0; v < n; v++) {
+                double d = std::min(fromDists.back()[v], toDists.back()[v]);
+                if (d != std::numeric_limits<double>::infinity())
+                    nearest[v] = std::min(nearest[v], d);
+                if (nearest[v] != std::numeric_limits<double>::infinity() && nearest[v] > farthest) {
+                    farthest = nearest[v];
+                    next = v;
+                }
+            }
+            if (farthest == 0.0)
                 break;
-            for (auto &edge : graphDriving[u]) {
-                std::size_t v = edge.first;
-                double weight = edge.second;
-                if (dist[u] + weight < dist[v]) {
-                    dist[v] = dist[u] + weight;
-                    prev[v] = u;
-                    pq.push({dist[v], v});
+        }
+
+        std::size_t k = table.landmarks.size();
+        table.landmarkCount = k;
+        table.fromLandmark.resize(n * k);
+        table.toLandmark.resize(n * k);
+        for (std::size_t v = 0; v < n; v++) {
+            for (std::size_t l = 0; l < k; l++) {
+                table.fromLandmark[v * k + l] = fromDists[l][v];
+                table.toLandmark[v * k + l] = toDists[l][v];
+            }
+        }
+    }
+
+    void precomputeLandmarks(std::chrono::steady_clock::time_point deadline) {
+        buildLandmarks({&graphDriving}, landmarksDriving, deadline);
+        buildLandmarks({&graphWalking, &graphBiking}, landmarksWalkBike, deadline);
+    }
+
+    // Landmark bound from search vertex v to dest. A virtual dest is only
+    // entered from the ends of its chain, so the smaller of their bounds
+    // holds for it; virtual vertices themselves get no bound.
+    double landmarkBound(const SLandmarkTable &table, std::size_t v, const SEndpoint &dest) const {
+        if (v >= vertexCount() || (dest.shape && dest.chain == InvalidIndex32))
+            return 0.0;
+        if (!dest.shape)
+            return table.Bound(v, dest.vertex);
+        return std::min(table.Bound(v, nodeVertices[chainNode(dest.chain * 2, 0)]),
+                        table.Bound(v, nodeVertices[chainNode(dest.chain * 2 + 1, 0)]));
+    }
+
+    // Lower bound on the remaining time of a fastest path from vertex to
+    // dest. Any path without a bus ride is bounded by the walk/bike
+    // landmarks; any path with one costs at least the bus stop time, so the
+    // smaller of the two stays admissible and consistent.
+    double fastestHeuristic(std::size_t vertex, const SEndpoint &dest) const {
+        double bound = landmarkBound(landmarksWalkBike, vertex, dest);
+        if (!routeStops.empty())
+            bound = std::min(bound, the_config->BusStopTime());
+        return bound;
+    }
+
+    // Lower bound on the driving time from node to dest. The straight chord
+    // through the earth is never longer than the haversine arc, so chord
+    // length at the fastest speed in the graph is admissible and consistent
+    // while avoiding the trigonometry of HaversineDistanceInMiles per push.
+    double drivingHeuristic(std::size_t node, std::size_t dest) const {
+        const double EarthRadiusMiles = 3959.88;
+        const double RoundingSlack = 1.0 - 1e-9;
+        if (maxDrivingSpeed <= 0.0)
+            return 0.0;
+        const auto &a = nodeUnitVectors[node];
+        const auto &b = nodeUnitVectors[dest];
+        double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+        return std::sqrt(dx * dx + dy * dy + dz * dz) * EarthRadiusMiles * RoundingSlack / maxDrivingSpeed;
+    }
+
+    // Weight of the lightest driving edge from u to v
+    double drivingEdgeWeight(std::size_t u, std::size_t v) const {
+        double weight = std::numeric_limits<double>::max();
+        for (uint32_t e = graphDriving.EdgeBegin(u); e < graphDriving.EdgeEnd(u); e++) {
+            if (graphDriving.targets[e] == v)
+                weight = std::min(weight, graphDriving.weights[e]);
+        }
+        return weight;
+    }
+
+    // Bidirectional Dijkstra over graphDriving and graphDrivingReverse. The
+    // direction with the smaller queue top advances, and the search stops
+    // once the two tops sum to at least the best meeting distance.
+    double bidirectionalDriving(const SEndpoint &src, const SEndpoint &dest, std::vector<std::size_t> &pathIndices) {
+        CSearchWorkspace &forwardSearch = QueryWorkspace();
+        CSearchWorkspace &backwardSearch = ReverseQueryWorkspace();
+        forwardSearch.Reset(searchSize());
+        backwardSearch.Reset(searchSize());
+        std::vector<SOverlayEdge> forwardOverlay, backwardOverlay;
+        overlayEdges(graphDriving, src, dest, forwardOverlay);
+        overlayEdges(graphDrivingReverse, dest, src, backwardOverlay);
+        forwardSearch.Update(src.vertex, 0.0, CSearchWorkspace::InvalidIndex);
+        backwardSearch.Update(dest.vertex, 0.0, CSearchWorkspace::InvalidIndex);
+        forwardSearch.Push(0.0, 0.0, src.vertex);
+        backwardSearch.Push(0.0, 0.0, dest.vertex);
+
+        double best = src.vertex == dest.vertex ? 0.0 : std::numeric_limits<double>::max();
+        std::size_t meet = src.vertex == dest.vertex ? src.vertex : CSearchWorkspace::InvalidIndex;
+        while (!forwardSearch.QueueEmpty() && !backwardSearch.QueueEmpty()) {
+            if (forwardSearch.Top().DKey + backwardSearch.Top().DKey >= best)
+                break;
+            bool forward = forwardSearch.Top().DKey <= backwardSearch.Top().DKey;
+            auto &search = forward ? forwardSearch : backwardSearch;
+            const auto &otherSearch = forward ? backwardSearch : forwardSearch;
+            const auto &graph = forward ? graphDriving : graphDrivingReverse;
+
+            auto item = search.Pop();
+            double d = item.DDistance;
+            std::size_t u = item.DIndex;
+            if (d > search.Distance(u))
+                continue;
+            forEachEdge(graph, forward ? forwardOverlay : backwardOverlay, forward ? src : dest, forward ? dest : src, u, d,
+                        [&](std::size_t v, double alt, int tag) {
+                if (alt < search.Distance(v)) {
+                    search.Update(v, alt, u, tag);
+                    search.Push(alt, alt, v);
+                    if (otherSearch.Reached(v) && alt + otherSearch.Distance(v) < best) {
+                        best = alt + otherSearch.Distance(v);
+                        meet = v;
+                    }
                 }
+            });
+        }
+        if (meet == CSearchWorkspace::InvalidIndex)
+            return std::numeric_limits<double>::max();
+
+        std::vector<std::size_t> vertices;
+        for (std::size_t at = meet; at != CSearchWorkspace::InvalidIndex; at = forwardSearch.Previous(at))
+            vertices.push_back(at);
+        std::reverse(vertices.begin(), vertices.end());
+        std::vector<std::size_t> path{src.node};
+        for (std::size_t i = 1; i < vertices.size(); i++)
+            appendStep(forwardSearch.Tag(vertices[i]), vertices[i - 1], vertices[i], src, dest, path);
+        // Sum the backward half in path order so costs match a forward search
+        double cost = forwardSearch.Distance(meet);
+        for (std::size_t at = meet, next = backwardSearch.Previous(meet); next != CSearchWorkspace::InvalidIndex;
+             at = next, next = backwardSearch.Previous(next)) {
+            if (!graphDriving.Contracted()) {
+                cost += drivingEdgeWeight(at, next);
+                path.push_back(next);
+                continue;
             }
+            // The backward search followed the chain the other way
+            uint32_t ref = static_cast<uint32_t>(backwardSearch.Tag(at) - ChainTag) ^ 1;
+            auto range = stepRange(ref, at, next, src, dest);
+            cost = foldChain(graphDriving.segmentWeights, ref, range.first, range.second, cost);
+            appendStep(ChainTag + static_cast<int>(ref), at, next, src, dest, path);
         }
-        if (dist[dest] == std::numeric_limits<double>::max())
-            return dist[dest];
-        std::vector<std::size_t> revPath;
-        for (int at = static_cast<int>(dest); at != -1; at = prev[at])
-            revPath.push_back(at);
-        std::reverse(revPath.begin(), revPath.end());
-        pathIndices = revPath;
-        return dist[dest];
+        pathIndices = path;
+        return cost;
+    }
+
+    // Shortest driving time search. AStar and ALT order the queue by
+    // distance plus a lower bound on the remaining time (drivingHeuristic or
+    // the landmark bound respectively); Dijkstra uses no bound and
+    // Bidirectional searches from both ends. Path indices are node indices.
+    double dijkstraDriving(TNodeID srcID, TNodeID destID, std::vector<std::size_t> &pathIndices, ESearchAlgorithm algorithm = ESearchAlgorithm::Dijkstra) {
+        SEndpoint src, dest;
+        if (!resolveQuery(srcID, destID, src, dest))
+            return std::numeric_limits<double>::max();
+        if (algorithm == ESearchAlgorithm::Bidirectional)
+            return bidirectionalDriving(src, dest, pathIndices);
+        CSearchWorkspace &search = QueryWorkspace();
+        search.Reset(searchSize());
+        std::vector<SOverlayEdge> overlay;
+        overlayEdges(graphDriving, src, dest, overlay);
+        auto heuristic = [&](std::size_t v) {
+            if (algorithm == ESearchAlgorithm::AStar)
+                return drivingHeuristic(searchNode(v, src, dest), dest.node);
+            if (algorithm == ESearchAlgorithm::ALT)
+                return landmarkBound(landmarksDriving, v, dest);
+            return 0.0;
+        };
+        // Queue keys are the estimated total, distance so far breaks ties
+        search.Update(src.vertex, 0.0, CSearchWorkspace::InvalidIndex);
+        search.Push(heuristic(src.vertex), 0.0, src.vertex);
+        while (!search.QueueEmpty()) {
+            auto item = search.Pop();
+            double d = item.DDistance;
+            std::size_t u = item.DIndex;
+            if (d > search.Distance(u))
+                continue;
+            if (u == dest.vertex)
+                break;
+            forEachEdge(graphDriving, overlay, src, dest, u, d, [&](std::size_t v, double alt, int tag) {
+                if (alt < search.Distance(v)) {
+                    double bound = heuristic(v);
+                    if (bound == std::numeric_limits<double>::infinity())
+                        return;
+                    search.Update(v, alt, u, tag);
+                    search.Push(alt + bound, alt, v);
+                }
+            });
+        }
+        if (!search.Reached(dest.vertex))
+            return std::numeric_limits<double>::max();
+        std::vector<std::size_t> vertices;
+        for (std::size_t at = dest.vertex; at != CSearchWorkspace::InvalidIndex; at = search.Previous(at))
+            vertices.push_back(at);
+        std::reverse(vertices.begin(), vertices.end());
+        std::vector<std::size_t> path{src.node};
+        for (std::size_t i = 1; i < vertices.size(); i++)
+            appendStep(search.Tag(vertices[i]), vertices[i - 1], vertices[i], src, dest, path);
+        pathIndices = path;
+        return search.Distance(dest.vertex);
     }
 
     std::size_t NodeCount() const noexcept {
-        return sortedNodes.size();
+        return sortedNodeIDs.size();
     }
 
     std::shared_ptr<CStreetMap::SNode> SortedNodeByIndex(std::size_t index) const noexcept {
         if (index < sortedNodes.size())
             return sortedNodes[index];
+        if (index < sortedNodeIDs.size())
+            return std::make_shared<SSnapshotNode>(sortedNodeIDs[index], nodeLocations[index]);
         return nullptr;
     }
 
     double FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path) {
         std::vector<std::size_t> indices;
-        double cost = dijkstraDriving(src, dest, indices);
+        double cost = dijkstraDriving(src, dest, indices, the_config->SearchAlgorithm());
         if (cost < std::numeric_limits<double>::max()) {
             path.clear();
             for (auto idx : indices)
-                path.push_back(sortedNodes[idx]->ID());
+                path.push_back(sortedNodeIDs[idx]);
         }
         return cost;
     }
 
+    // Fastest trip by a round based (RAPTOR style) search. Each round scans
+    // the routes serving stops whose walking time improved in the previous
+    // round, boarding at whichever earlier stop gives the best arrival, and
+    // then spreads the improved stops over the walk/bike street graph with
+    // a multi-source Dijkstra. Round k therefore finds trips with k bus
+    // rides, and the search ends once a round improves no stop. Labels are
+    // kept across rounds so each state holds its best time over all rounds.
     double FindFastestPath(TNodeID src, TNodeID dest, std::vector<TTripStep> &tripPath) {
         enum class Mode {
             Walk,
@@ -157,156 +1144,309 @@ struct CDijkstraTransportationPlanner::SImplementation {
         };
         const int modeCount = 2;
 
-        auto stateToIndex = [modeCount](std::size_t node, Mode m) {
-            return node * modeCount + static_cast<int>(m);
+        auto stateToIndex = [modeCount](std::size_t vertex, Mode m) {
+            return vertex * modeCount + static_cast<int>(m);
         };
 
-        std::size_t n = sortedNodes.size();
-        std::vector<double> dist(n * modeCount, std::numeric_limits<double>::max());
-        std::vector<int> prev(n * modeCount, -1);
-        std::vector<int> prevEdgeType(n * modeCount, -1);
-
-        using QueueItem = std::pair<double, int>;
-        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> pq;
-
-        if (nodeIndexMap.find(src) == nodeIndexMap.end() ||
-            nodeIndexMap.find(dest) == nodeIndexMap.end())
+        SEndpoint srcEnd, destEnd;
+        if (!resolveQuery(src, dest, srcEnd, destEnd))
             return std::numeric_limits<double>::max();
-        int startState = stateToIndex(nodeIndexMap[src], Mode::Walk);
-        dist[startState] = 0.0;
-        pq.push({0.0, startState});
+        std::size_t destWalk = stateToIndex(destEnd.vertex, Mode::Walk);
+        std::size_t destBike = stateToIndex(destEnd.vertex, Mode::Bike);
+        std::vector<SOverlayEdge> overlayWalking, overlayBiking;
+        overlayEdges(graphWalking, srcEnd, destEnd, overlayWalking);
+        overlayEdges(graphBiking, srcEnd, destEnd, overlayBiking);
+        // Tags record the edge type that reached a state, 1 for a bus ride
+        // and ChainTag onwards for a contracted street edge
+        CSearchWorkspace &search = QueryWorkspace();
+        search.Reset(searchSize() * modeCount);
+        bool useLandmarks = the_config->SearchAlgorithm() == ESearchAlgorithm::ALT;
+        auto bestAtDest = [&]() {
+            return std::min(search.Distance(destWalk), search.Distance(destBike));
+        };
+        // Stops whose walking time improved, the boarding points of the next round
+        std::vector<std::size_t> markedStops;
+        // Records and queues a state unless it cannot beat the best time at
+        // dest, the landmark bound pruning states that cannot reach dest
+        auto relaxState = [&](std::size_t state, double cost, std::size_t previous, int edgeType) {
+            if (cost >= search.Distance(state))
+                return;
+            double bound = useLandmarks ? fastestHeuristic(state / modeCount, destEnd) : 0.0;
+            if (cost + bound >= bestAtDest())
+                return;
+            search.Update(state, cost, previous, edgeType);
+            search.Push(cost + bound, cost, state);
+            std::size_t vertex = state / modeCount;
+            if (state % modeCount == static_cast<std::size_t>(Mode::Walk) && vertex < vertexCount() &&
+                stopVisitOffsets[vertex] != stopVisitOffsets[vertex + 1])
+                markedStops.push_back(vertex);
+        };
 
-        while (!pq.empty()) {
-            auto [curCost, curStateIdx] = pq.top();
-            pq.pop();
-            if (curCost > dist[curStateIdx])
-                continue;
-            std::size_t curNode = curStateIdx / modeCount;
-            Mode curMode = static_cast<Mode>(curStateIdx % modeCount);
-
-            if (sortedNodes[curNode]->ID() == dest) {
-                std::vector<int> statePath;
-                int cur = curStateIdx;
-                while (cur != -1) {
-                    statePath.push_back(cur);
-                    cur = prev[cur];
+        auto streetSearch = [&]() {
+            while (!search.QueueEmpty()) {
+                auto item = search.Pop();
+                if (item.DKey >= bestAtDest()) {
+                    search.ClearQueue();
+                    break;
                 }
-                std::reverse(statePath.begin(), statePath.end());
-                tripPath.clear();
-                for (int state : statePath) {
-                    std::size_t nodeIdx = state / modeCount;
-                    ETransportationMode mode;
-                    if (prevEdgeType[state] == 1)
-                        mode = ETransportationMode::Bus;
-                    else if ((state % modeCount) == static_cast<int>(Mode::Bike))
-                        mode = ETransportationMode::Bike;
-                    else
-                        mode = ETransportationMode::Walk;
-                    tripPath.push_back({mode, sortedNodes[nodeIdx]->ID()});
-                }
-                return curCost;
+                double curCost = item.DDistance;
+                std::size_t curStateIdx = item.DIndex;
+                if (curCost > search.Distance(curStateIdx))
+                    continue;
+                std::size_t curVertex = curStateIdx / modeCount;
+                Mode curMode = static_cast<Mode>(curStateIdx % modeCount);
+                const SCompactGraph &graph = curMode == Mode::Walk ? graphWalking : graphBiking;
+                forEachEdge(graph, curMode == Mode::Walk ? overlayWalking : overlayBiking, srcEnd, destEnd, curVertex, curCost,
+                            [&](std::size_t v, double newCost, int tag) {
+                    relaxState(stateToIndex(v, curMode), newCost, curStateIdx, tag);
+                });
+                std::size_t otherState = stateToIndex(curVertex, (curMode == Mode::Walk ? Mode::Bike : Mode::Walk));
+                relaxState(otherState, curCost, curStateIdx, 0);
             }
+        };
 
-            if (curMode == Mode::Walk) {
-                for (auto &edge : graphWalking[curNode]) {
-                    int nextState = stateToIndex(edge.first, Mode::Walk);
-                    double newCost = curCost + edge.second;
-                    if (newCost < dist[nextState]) {
-                        dist[nextState] = newCost;
-                        prev[nextState] = curStateIdx;
-                        prevEdgeType[nextState] = 0;
-                        pq.push({newCost, nextState});
-                    }
+        // Rides one route from its first marked position. The boarding stop
+        // is the one minimizing its time minus the distance already covered,
+        // which gives the earliest arrival at every later stop.
+        auto scanRoute = [&](std::size_t route, std::size_t firstPosition) {
+            std::size_t boardPosition = CSearchWorkspace::InvalidIndex;
+            double boardCost = 0.0;
+            double speed = the_config->DefaultSpeedLimit();
+            for (std::size_t position = firstPosition; position < routeOffsets[route + 1]; position++) {
+                std::size_t node = routeStops[position];
+                if (boardPosition != CSearchWorkspace::InvalidIndex) {
+                    double busTime = (routeDistances[position] - routeDistances[boardPosition]) / speed;
+                    double newCost = boardCost + (the_config->BusStopTime() + busTime);
+                    if (node != routeStops[boardPosition])
+                        relaxState(stateToIndex(node, Mode::Walk), newCost, stateToIndex(routeStops[boardPosition], Mode::Walk), 1);
+                }
+                double cost = search.Distance(stateToIndex(node, Mode::Walk));
+                if (cost == std::numeric_limits<double>::max())
+                    continue;
+                if (boardPosition == CSearchWorkspace::InvalidIndex ||
+                    cost - routeDistances[position] / speed < boardCost - routeDistances[boardPosition] / speed) {
+                    boardPosition = position;
+                    boardCost = cost;
                 }
             }
-            else if (curMode == Mode::Bike) {
-                for (auto &edge : graphBiking[curNode]) {
-                    int nextState = stateToIndex(edge.first, Mode::Bike);
-                    double newCost = curCost + edge.second;
-                    if (newCost < dist[nextState]) {
-                        dist[nextState] = newCost;
-                        prev[nextState] = curStateIdx;
-                        prevEdgeType[nextState] = 0;
-                        pq.push({newCost, nextState});
-                    }
+        };
+
+        // Round 0 walks and bikes from src, later rounds add one ride each
+        relaxState(stateToIndex(srcEnd.vertex, Mode::Walk), 0.0, CSearchWorkspace::InvalidIndex, -1);
+        streetSearch();
+        std::vector<std::pair<uint32_t, uint32_t>> routesToScan; // {route, first marked position}
+        while (!markedStops.empty()) {
+            routesToScan.clear();
+            for (auto node : markedStops) {
+                for (uint32_t v = stopVisitOffsets[node]; v < stopVisitOffsets[node + 1]; v++) {
+                    uint32_t position = stopVisits[v];
+                    uint32_t route = std::upper_bound(routeOffsets.begin(), routeOffsets.end(), position) - routeOffsets.begin() - 1;
+                    routesToScan.push_back({route, position});
                 }
             }
+            markedStops.clear();
+            std::sort(routesToScan.begin(), routesToScan.end());
+            for (std::size_t i = 0; i < routesToScan.size(); i++) {
+                if (i == 0 || routesToScan[i].first != routesToScan[i - 1].first)
+                    scanRoute(routesToScan[i].first, routesToScan[i].second);
+            }
+            streetSearch();
+        }
 
-            int otherState = stateToIndex(curNode, (curMode == Mode::Walk ? Mode::Bike : Mode::Walk));
-            if (curCost < dist[otherState]) {
-                dist[otherState] = curCost;
-                prev[otherState] = curStateIdx;
-                prevEdgeType[otherState] = 0;
-                pq.push({curCost, otherState});
+        double bestCost = bestAtDest();
+        if (bestCost == std::numeric_limits<double>::max())
+            return bestCost;
+        std::size_t destState = search.Distance(destWalk) <= search.Distance(destBike) ? destWalk : destBike;
+        std::vector<std::size_t> statePath;
+        for (std::size_t cur = destState; cur != CSearchWorkspace::InvalidIndex; cur = search.Previous(cur))
+            statePath.push_back(cur);
+        std::reverse(statePath.begin(), statePath.end());
+        tripPath.clear();
+        std::vector<std::size_t> stepNodes;
+        for (std::size_t i = 0; i < statePath.size(); i++) {
+            std::size_t state = statePath[i];
+            int tag = search.Tag(state);
+            ETransportationMode mode;
+            if (tag == 1)
+                mode = ETransportationMode::Bus;
+            else if (state % modeCount == static_cast<std::size_t>(Mode::Bike))
+                mode = ETransportationMode::Bike;
+            else
+                mode = ETransportationMode::Walk;
+            // A contracted street edge passes the shape points of its chain
+            stepNodes.clear();
+            if (i > 0)
+                appendStep(tag, statePath[i - 1] / modeCount, state / modeCount, srcEnd, destEnd, stepNodes);
+            else
+                stepNodes.push_back(srcEnd.node);
+            for (auto node : stepNodes)
+                tripPath.push_back({mode, sortedNodeIDs[node]});
+        }
+        return bestCost;
+    }
+
+    // The configuration values the stored graphs and tables depend on
+    void writeConfig(CSnapshotWriter &writer) const {
+        writer.Value(the_config->WalkSpeed());
+        writer.Value(the_config->BikeSpeed());
+        writer.Value(the_config->DefaultSpeedLimit());
+        writer.Value(the_config->BusStopTime());
+        writer.Value(static_cast<uint32_t>(the_config->SearchAlgorithm()));
+        writer.Value(static_cast<uint32_t>(the_config->ContractGraphs()));
+    }
+
+    // Size and modification time of every input file, so a snapshot is not
+    // used once its street map or bus system files change. Missing files
+    // get a size no file can have.
+    static std::vector<uint64_t> inputFingerprint(const std::vector<std::string> &inputs) {
+        std::vector<uint64_t> fingerprint;
+        for (auto &input : inputs) {
+            std::error_code sizeError, timeError;
+            uint64_t size = std::filesystem::file_size(input, sizeError);
+            auto modified = std::filesystem::last_write_time(input, timeError);
+            if (sizeError || timeError) {
+                fingerprint.insert(fingerprint.end(), {std::numeric_limits<uint64_t>::max(), 0});
+                continue;
             }
+            fingerprint.push_back(size);
+            fingerprint.push_back(static_cast<uint64_t>(modified.time_since_epoch().count()));
+        }
+        return fingerprint;
+    }
 
-            if (curMode == Mode::Walk) {
-                auto busStop = busIndexer->StopByNodeID(sortedNodes[curNode]->ID());
-                if (busStop) {
-                    for (std::size_t i = 0; i < the_config->BusSystem()->RouteCount(); i++) {
-                        auto route = the_config->BusSystem()->RouteByIndex(i);
-                        std::size_t stopCount = route->StopCount();
-                        int currentIndexInRoute = -1;
-                        for (std::size_t j = 0; j < stopCount; j++) {
-                            if (route->GetStopID(j) == busStop->ID()) {
-                                currentIndexInRoute = static_cast<int>(j);
-                                break;
-                            }
-                        }
-                        if (currentIndexInRoute != -1 && currentIndexInRoute < static_cast<int>(stopCount - 1)) {
-                            double bestRemainingDist = std::numeric_limits<double>::max();
-                            std::size_t bestAlightNode = 0;
-                            double bestBusTime = 0.0;
-                            for (std::size_t j = currentIndexInRoute + 1; j < stopCount; j++) {
-                                auto alightStop = the_config->BusSystem()->StopByIndex(j);
-                                if (!alightStop)
-                                    continue;
-                                TNodeID alightNodeID = alightStop->NodeID();
-                                if (nodeIndexMap.find(alightNodeID) == nodeIndexMap.end())
-                                    continue;
-                                std::size_t alightNodeIdx = nodeIndexMap[alightNodeID];
-                                double routeDistance = 0.0;
-                                for (std::size_t k = currentIndexInRoute; k < j; k++) {
-                                    auto stopA = the_config->BusSystem()->StopByIndex(k);
-                                    auto stopB = the_config->BusSystem()->StopByIndex(k + 1);
-                                    if (!stopA || !stopB)
-                                        continue;
-                                    TNodeID nodeA = stopA->NodeID();
-                                    TNodeID nodeB = stopB->NodeID();
-                                    if (nodeIndexMap.find(nodeA) == nodeIndexMap.end() ||
-                                        nodeIndexMap.find(nodeB) == nodeIndexMap.end())
-                                        continue;
-                                    auto locA = sortedNodes[nodeIndexMap[nodeA]]->Location();
-                                    auto locB = sortedNodes[nodeIndexMap[nodeB]]->Location();
-                                    routeDistance += SGeographicUtils::HaversineDistanceInMiles(locA, locB);
-                                }
-                                double busTime = routeDistance / the_config->DefaultSpeedLimit();
-                                auto destLoc = sortedNodes[nodeIndexMap[dest]]->Location();
-                                auto alightLoc = sortedNodes[alightNodeIdx]->Location();
-                                double remainingDist = SGeographicUtils::HaversineDistanceInMiles(destLoc, alightLoc);
-                                if (remainingDist < bestRemainingDist) {
-                                    bestRemainingDist = remainingDist;
-                                    bestAlightNode = alightNodeIdx;
-                                    bestBusTime = busTime;
-                                }
-                            }
-                            if (bestRemainingDist < std::numeric_limits<double>::max()) {
-                                double totalBusCost = the_config->BusStopTime() + bestBusTime;
-                                int nextState = stateToIndex(bestAlightNode, Mode::Walk);
-                                double newCost = curCost + totalBusCost;
-                                if (newCost < dist[nextState]) {
-                                    dist[nextState] = newCost;
-                                    prev[nextState] = curStateIdx;
-                                    prevEdgeType[nextState] = 1;
-                                    pq.push({newCost, nextState});
-                                }
-                            }
-                        }
-                    }
-                }
+    bool WriteSnapshot(const std::string &filename, const std::vector<std::string> &inputs) const {
+        CSnapshotWriter writer(filename);
+        if (!writer.Valid())
+            return false;
+        writer.Value(SnapshotMagic);
+        writer.Value(SnapshotVersion);
+        writer.Value(SnapshotByteOrder);
+        writeConfig(writer);
+        writer.Array(inputFingerprint(inputs));
+        writer.Array(sortedNodeIDs);
+        std::vector<double> coordinates; // latitude and longitude pairs
+        for (auto &location : nodeLocations) {
+            coordinates.push_back(location.first);
+            coordinates.push_back(location.second);
+        }
+        writer.Array(coordinates);
+        writer.Array(nodeUnitVectors);
+        writer.Array(vertexNodes);
+        writer.Array(chainOffsets);
+        writer.Array(chainNodes);
+        writer.Value(maxDrivingSpeed);
+        graphDriving.Write(writer);
+        graphDrivingReverse.Write(writer);
+        graphWalking.Write(writer);
+        graphBiking.Write(writer);
+        writer.Array(routeOffsets);
+        writer.Array(routeStops);
+        writer.Array(routeDistances);
+        writer.Array(stopVisitOffsets);
+        writer.Array(stopVisits);
+        landmarksDriving.Write(writer);
+        landmarksWalkBike.Write(writer);
+        return writer.Valid();
+    }
+
+    // Checks the vertex and chain tables read from a snapshot: vertices are
+    // distinct nodes in node order, and every chain runs through at least
+    // one segment between two vertices
+    bool validChains() const {
+        std::size_t n = sortedNodeIDs.size();
+        if (vertexNodes.empty())
+            return chainOffsets.empty() && chainNodes.empty();
+        for (std::size_t v = 0; v < vertexNodes.size(); v++) {
+            if (vertexNodes[v] >= n || (v && vertexNodes[v] <= vertexNodes[v - 1]))
+                return false;
+        }
+        if (chainOffsets.empty() || chainOffsets.front() != 0 || chainOffsets.back() != chainNodes.size())
+            return false;
+        for (std::size_t c = 0; c + 1 < chainOffsets.size(); c++) {
+            if (chainOffsets[c + 1] < chainOffsets[c] + 2)
+                return false;
+        }
+        if (!std::all_of(chainNodes.begin(), chainNodes.end(), [n](uint32_t node) { return node < n; }))
+            return false;
+        for (std::size_t c = 0; c + 1 < chainOffsets.size(); c++) {
+            for (uint32_t end : {chainNodes[chainOffsets[c]], chainNodes[chainOffsets[c + 1] - 1]}) {
+                if (!std::binary_search(vertexNodes.begin(), vertexNodes.end(), end))
+                    return false;
             }
         }
-        return std::numeric_limits<double>::max();
+        return true;
+    }
+
+    // Checks the snapshot is this version and was built with the same
+    // configuration values from unchanged input files
+    bool readSnapshotHeader(CSnapshotReader &reader, const std::vector<std::string> &inputs) const {
+        char magic[sizeof(SnapshotMagic)];
+        uint32_t version = 0, byteOrder = 0, algorithm = 0, contract = 0;
+        double walkSpeed = 0.0, bikeSpeed = 0.0, speedLimit = 0.0, busStopTime = 0.0;
+        reader.Value(magic);
+        reader.Value(version);
+        reader.Value(byteOrder);
+        if (!reader.Valid() || std::memcmp(magic, SnapshotMagic, sizeof(magic)) || version != SnapshotVersion || byteOrder != SnapshotByteOrder)
+            return false;
+        reader.Value(walkSpeed);
+        reader.Value(bikeSpeed);
+        reader.Value(speedLimit);
+        reader.Value(busStopTime);
+        reader.Value(algorithm);
+        reader.Value(contract);
+        if (!reader.Valid() || walkSpeed != the_config->WalkSpeed() || bikeSpeed != the_config->BikeSpeed() ||
+            speedLimit != the_config->DefaultSpeedLimit() || busStopTime != the_config->BusStopTime() ||
+            algorithm != static_cast<uint32_t>(the_config->SearchAlgorithm()) ||
+            contract != static_cast<uint32_t>(the_config->ContractGraphs()))
+            return false;
+        std::vector<uint64_t> fingerprint;
+        reader.Array(fingerprint);
+        return reader.Valid() && fingerprint == inputFingerprint(inputs);
+    }
+
+    // Fills a planner created without building from a snapshot. Returns
+    // false if the file is missing, from another version, built with a
+    // different configuration or inputs, or inconsistent.
+    bool ReadSnapshot(const std::string &filename, const std::vector<std::string> &inputs) {
+        CSnapshotReader reader(filename);
+        if (!readSnapshotHeader(reader, inputs))
+            return false;
+        std::vector<double> coordinates;
+        reader.Array(sortedNodeIDs);
+        reader.Array(coordinates);
+        reader.Array(nodeUnitVectors);
+        reader.Array(vertexNodes);
+        reader.Array(chainOffsets);
+        reader.Array(chainNodes);
+        reader.Value(maxDrivingSpeed);
+        std::size_t n = sortedNodeIDs.size();
+        if (!reader.Valid() || coordinates.size() != 2 * n || nodeUnitVectors.size() != n || !validChains())
+            return false;
+        nodeLocations.resize(n);
+        for (std::size_t i = 0; i < n; i++)
+            nodeLocations[i] = {coordinates[2 * i], coordinates[2 * i + 1]};
+        indexChains();
+        std::size_t vertices = vertexCount();
+        std::size_t chains = chainOffsets.empty() ? 0 : chainOffsets.size() - 1;
+        std::size_t segments = chainNodes.size() - chains;
+        if (!graphDriving.Read(reader, vertices, chains, segments) || !graphDrivingReverse.Read(reader, vertices, chains, segments) ||
+            !graphWalking.Read(reader, vertices, chains, segments) || !graphBiking.Read(reader, vertices, chains, segments))
+            return false;
+        reader.Array(routeOffsets);
+        reader.Array(routeStops);
+        reader.Array(routeDistances);
+        reader.Array(stopVisitOffsets);
+        reader.Array(stopVisits);
+        if (!reader.Valid() || routeOffsets.empty() || routeOffsets.back() != routeStops.size() ||
+            routeDistances.size() != routeStops.size() || stopVisitOffsets.size() != vertices + 1 ||
+            stopVisitOffsets.back() != stopVisits.size() || stopVisits.size() != routeStops.size())
+            return false;
+        if (!std::all_of(routeStops.begin(), routeStops.end(), [vertices](uint32_t vertex) { return vertex < vertices; }) ||
+            !std::all_of(stopVisits.begin(), stopVisits.end(), [this](uint32_t position) { return position < routeStops.size(); }))
+            return false;
+        if (!landmarksDriving.Read(reader, vertices) || !landmarksWalkBike.Read(reader, vertices))
+            return false;
+        return reader.Valid() && reader.AtEnd();
     }
 
     bool GetPathDescription(const std::vector<TTripStep> &path, std::vector<std::string> &desc) const {
@@ -319,10 +1459,41 @@ CDijkstraTransportationPlanner::CDijkstraTransportationPlanner(std::shared_ptr<S
     DImplementation = std::make_unique<SImplementation>(config);
 }
 
+CDijkstraTransportationPlanner::CDijkstraTransportationPlanner(std::unique_ptr<SImplementation> implementation)
+    : DImplementation(std::move(implementation)) {
+}
+
 CDijkstraTransportationPlanner::~CDijkstraTransportationPlanner() {
     // No explicit cleanup needed, unique_ptr handles it
 }
 
+// Writes the built planner (nodes, graphs, transit tables and precomputed
+// landmarks) to a binary snapshot that LoadSnapshot can map back in. The
+// size and modification time of each of the input files the planner was
+// built from are recorded with it.
+bool CDijkstraTransportationPlanner::WriteSnapshot(const std::string &filename, const std::vector<std::string> &inputs) const {
+    return DImplementation->WriteSnapshot(filename, inputs);
+}
+
+// Returns true if filename holds a snapshot of this version written with the
+// same configuration values and the same, unchanged inputs. Only the header
+// is read.
+bool CDijkstraTransportationPlanner::SnapshotMatches(const std::string &filename, std::shared_ptr<SConfiguration> config, const std::vector<std::string> &inputs) {
+    SImplementation Implementation(config, false);
+    CSnapshotReader Reader(filename);
+    return Implementation.readSnapshotHeader(Reader, inputs);
+}
+
+// Loads a planner from a snapshot written with the same configuration
+// values and inputs. Returns nullptr if the snapshot cannot be used, callers
+// then fall back to building the planner from the street map and bus system.
+std::shared_ptr<CDijkstraTransportationPlanner> CDijkstraTransportationPlanner::LoadSnapshot(const std::string &filename, std::shared_ptr<SConfiguration> config, const std::vector<std::string> &inputs) {
+    auto Implementation = std::make_unique<SImplementation>(config, false);
+    if (!Implementation->ReadSnapshot(filename, inputs))
+        return nullptr;
+    return std::shared_ptr<CDijkstraTransportationPlanner>(new CDijkstraTransportationPlanner(std::move(Implementation)));
+}
+
 std::size_t CDijkstraTransportationPlanner::NodeCount() const noexcept {
     return DImplementation->NodeCount();
 }
@@ -1,5 +1,6 @@
 #include "FileDataFactory.h"
 #include "FileDataSource.h"
+#include "MappedFileDataSource.h"
 #include "FileDataSink.h"
 #include <filesystem>
 
@@ -13,6 +14,15 @@ CFileDataFactory::CFileDataFactory(const std::string &path){
 }
 
 std::shared_ptr< CDataSource > CFileDataFactory::CreateSource(const std::string &name) noexcept{
+    // Regular files are memory mapped, anything else (pipes, devices) or a
+    // failed mapping falls back to the stream based source
+    std::error_code ErrorCode;
+    if(std::filesystem::is_regular_file(DBasePath + name,ErrorCode)){
+        auto MappedSource = std::make_shared<CMappedFileDataSource>(DBasePath + name);
+        if(MappedSource->Valid()){
+            return MappedSource;
+        }
+    }
     return std::make_shared<CFileDataSource>(DBasePath + name);
 }
 
@@ -11,6 +11,15 @@ bool CFileDataSink::Put(const char &ch) noexcept{
 }
 
 bool CFileDataSink::Write(const std::vector<char> &buf) noexcept{
-    DFile.write(buf.data(),buf.size());
+    return Write(buf.data(),buf.size());
+}
+
+bool CFileDataSink::Write(const char *data, std::size_t size) noexcept{
+    DFile.write(data,size);
+    return DFile.good();
+}
+
+bool CFileDataSink::Flush() noexcept{
+    DFile.flush();
     return DFile.good();
-}
\ No newline at end of file
+}
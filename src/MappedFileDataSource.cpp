@@ -0,0 +1,81 @@
+#include "MappedFileDataSource.h"
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+CMappedFileDataSource::CMappedFileDataSource(const std::string &filename) : DData(nullptr), DSize(0), DIndex(0), DValid(false){
+    int FileDescriptor = open(filename.c_str(), O_RDONLY);
+    if(FileDescriptor < 0){
+        return;
+    }
+    struct stat FileStat;
+    if(fstat(FileDescriptor, &FileStat) == 0 && S_ISREG(FileStat.st_mode)){
+        if(FileStat.st_size == 0){
+            // mmap rejects zero length mappings, an empty file is just at end
+            DValid = true;
+        }
+        else{
+            void *Mapping = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+            if(Mapping != MAP_FAILED){
+                madvise(Mapping, FileStat.st_size, MADV_SEQUENTIAL);
+                DData = static_cast<const char *>(Mapping);
+                DSize = FileStat.st_size;
+                DValid = true;
+            }
+        }
+    }
+    close(FileDescriptor);
+}
+
+CMappedFileDataSource::~CMappedFileDataSource(){
+    if(DData){
+        munmap(const_cast<char *>(DData), DSize);
+    }
+}
+
+bool CMappedFileDataSource::Valid() const noexcept{
+    return DValid;
+}
+
+bool CMappedFileDataSource::End() const noexcept{
+    return DIndex >= DSize;
+}
+
+bool CMappedFileDataSource::Get(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        DIndex++;
+        return true;
+    }
+    return false;
+}
+
+bool CMappedFileDataSource::Peek(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        return true;
+    }
+    return false;
+}
+
+bool CMappedFileDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    std::size_t Available = std::min(count, DSize - DIndex);
+    buf.assign(DData + DIndex, DData + DIndex + Available);
+    DIndex += Available;
+    return Available > 0;
+}
+
+bool CMappedFileDataSource::Borrow(const char *&data, std::size_t &size) noexcept{
+    if(DIndex >= DSize){
+        return false;
+    }
+    data = DData + DIndex;
+    size = DSize - DIndex;
+    return true;
+}
+
+void CMappedFileDataSource::Consume(std::size_t count) noexcept{
+    DIndex = std::min(DIndex + count, DSize);
+}
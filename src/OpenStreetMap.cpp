@@ -1,233 +1,328 @@
 #include "OpenStreetMap.h"
 #include "StreetMap.h"
 #include "XMLReader.h"  // Needed for CXMLReader definition in constructor
+#include "StreetMapStore.h"
 #include <vector>
-#include <map>
 #include <string>
 #include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <charconv>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 
-// Define the private implementation struct for PIMPL idiom
+// Nodes and ways live in a column store, see StreetMapStore.h
 struct COpenStreetMap::SImplementation {
-    struct Node:CStreetMap::SNode {
-        TNodeID DId; // store node's ID
-        TLocation DLocation; // stores lattitude/longtitude 
-        std::vector<std::pair<std::string, std::string>> DAttributes; // {"highway", "road"}
+    using SStore = SStreetMapStore;
 
-        // constuctor
-        Node(TNodeID id, TLocation loc, const std::vector<std::pair<std::string, std::string>>& attrs = {})
-            : DId(id), DLocation(loc), DAttributes(attrs) {}
+    std::shared_ptr<SStore> DStore = std::make_shared<SStore>();
 
-        // Returns the node's ID
-        TNodeID ID() const noexcept override {
-            return DId;
-        }
+    struct SParseHandler;
+    struct SBatch;
+    struct SParallelLoader;
+};
+
+// Appends nodes and ways to the store straight from parser events, without
+// materializing an SXMLEntity per element
+struct COpenStreetMap::SImplementation::SParseHandler : public CXMLReader::SHandler {
+    SStore &DStore;
+    bool DInNode = false;
+    bool DInWay = false;
+    // Reused so interning a string already in the table does not allocate
+    std::string DKey;
+    std::string DValue;
 
-        // Returns the node's location (lat, lon)
-        TLocation Location() const noexcept override {
-            return DLocation;
+    SParseHandler(SStore &store) : DStore(store) {}
+
+    // Returns the value of the named attribute, or "" if it is missing
+    static const char *FindAttribute(const char **attrs, const char *name) {
+        for (int i = 0; attrs && attrs[i]; i += 2) {
+            if (std::strcmp(attrs[i], name) == 0) {
+                return attrs[i + 1];
+            }
         }
+        return "";
+    }
 
-        // Returns the number of attributes
-        std::size_t AttributeCount() const noexcept override {
-            return DAttributes.size();
+    static uint64_t ParseID(const char *value) {
+        uint64_t id = 0;
+        const char *end = value + std::strlen(value);
+        auto result = std::from_chars(value, end, id);
+        if (result.ec != std::errc() || result.ptr == value) {
+            throw std::invalid_argument(std::string("Invalid OSM id: \"") + value + "\"");
         }
+        return id;
+    }
 
-        // Returns the key at the given index, or "" if invalid
-        std::string GetAttributeKey(std::size_t index) const noexcept override {
-            if (index >= DAttributes.size()) {
-                return "";
-            }
-            return DAttributes[index].first;
+    static double ParseCoordinate(const char *value) {
+        char *end;
+        double coordinate = std::strtod(value, &end);
+        if (end == value) {
+            throw std::invalid_argument(std::string("Invalid OSM coordinate: \"") + value + "\"");
         }
+        return coordinate;
+    }
 
-        // Checks if the key exists in attributes
-        bool HasAttribute(const std::string& key) const noexcept override {
-            for (const auto& attr : DAttributes) {
-                if (attr.first == key) {
-                    return true;
-                }
+    void StartElement(const char *name, const char **attrs) override {
+        if (std::strcmp(name, "node") == 0) {
+            TNodeID id = ParseID(FindAttribute(attrs, "id"));
+            double lat = ParseCoordinate(FindAttribute(attrs, "lat"));
+            double lon = ParseCoordinate(FindAttribute(attrs, "lon"));
+            DStore.AddNode(id, {lat, lon});
+            DInNode = true;
+        } else if (std::strcmp(name, "way") == 0) {
+            DStore.AddWay(ParseID(FindAttribute(attrs, "id")));
+            DInWay = true;
+        } else if (std::strcmp(name, "nd") == 0) {
+            if (DInWay) {
+                DStore.DWayNodeIDs.push_back(ParseID(FindAttribute(attrs, "ref")));
+            }
+        } else if (std::strcmp(name, "tag") == 0) {
+            if (DInNode || DInWay) {
+                DKey.assign(FindAttribute(attrs, "k"));
+                DValue.assign(FindAttribute(attrs, "v"));
+                SStore::TAttribute attribute(DStore.Intern(DKey), DStore.Intern(DValue));
+                (DInNode ? DStore.DNodeAttributes : DStore.DWayAttributes).push_back(attribute);
             }
-            return false;
         }
+    }
 
-        // Returns the value for the key, or "" if not found
-        std::string GetAttribute(const std::string& key) const noexcept override {
-            for (const auto& attr : DAttributes) {
-                if (attr.first == key) {
-                    return attr.second;
-                }
-            }
-            return "";
+    void EndElement(const char *name) override {
+        if (std::strcmp(name, "node") == 0) {
+            DInNode = false;
+        } else if (std::strcmp(name, "way") == 0) {
+            DInWay = false;
         }
+    }
+};
+
+// Parser events recorded for replay on a worker thread. Strings are kept
+// null terminated in one buffer and referenced by offset.
+struct COpenStreetMap::SImplementation::SBatch {
+    struct SEvent {
+        std::size_t DName;
+        std::size_t DAttributes;
+        std::size_t DAttributeCount;
+        bool DEnd;
     };
 
-    // Way
-    struct Way:CStreetMap::SWay{
-        TWayID DId;  // Way's unique ID
-        std::vector<TNodeID> DNodeIds;  // List of node IDs in the way
-        std::vector<std::pair<std::string, std::string>> DAttributes;  // Key-value tags
+    std::string DText;
+    std::vector<SEvent> DEvents;
+    std::vector<std::size_t> DAttributes;
 
-        // Constructor to initialize the way
-        Way(TWayID id, const std::vector<TNodeID>& nodeIds, 
-            const std::vector<std::pair<std::string, std::string>>& attrs = {})
-            : DId(id), DNodeIds(nodeIds), DAttributes(attrs) {}
+    std::size_t Add(const char *str) {
+        std::size_t offset = DText.size();
+        DText.append(str);
+        DText.push_back('\0');
+        return offset;
+    }
 
-        // Returns the way's ID
-        TWayID ID() const noexcept override {
-            return DId;
+    void StartElement(const char *name, const char **attrs) {
+        SEvent event{Add(name), DAttributes.size(), 0, false};
+        for (int i = 0; attrs && attrs[i]; i++) {
+            DAttributes.push_back(Add(attrs[i]));
+            event.DAttributeCount++;
         }
+        DEvents.push_back(event);
+    }
 
-        // Returns the number of nodes in the way
-        std::size_t NodeCount() const noexcept override {
-            return DNodeIds.size();
-        }
+    void EndElement(const char *name) {
+        DEvents.push_back({Add(name), 0, 0, true});
+    }
 
-        // Returns the node ID at the given index, or InvalidNodeID if invalid
-        TNodeID GetNodeID(std::size_t index) const noexcept override {
-            if (index >= DNodeIds.size()) {
-                return CStreetMap::InvalidNodeID;  // Defined as max uint64_t
+    void Replay(CXMLReader::SHandler &handler) const {
+        std::vector<const char *> attrs;
+        for (auto &event : DEvents) {
+            const char *name = DText.data() + event.DName;
+            if (event.DEnd) {
+                handler.EndElement(name);
+                continue;
             }
-            return DNodeIds[index];
+            attrs.clear();
+            for (std::size_t i = 0; i < event.DAttributeCount; i++) {
+                attrs.push_back(DText.data() + DAttributes[event.DAttributes + i]);
+            }
+            attrs.push_back(nullptr);
+            handler.StartElement(name, attrs.data());
         }
+    }
+};
+
+// Pipelined load: the parsing thread records events into batches cut
+// between top level elements, and workers replay each batch through an
+// SParseHandler into a chunk store. Chunks are returned in file order.
+struct COpenStreetMap::SImplementation::SParallelLoader : public CXMLReader::SHandler {
+    static constexpr std::size_t BatchEvents = 16384;
 
-        // Returns the number of attributes
-        std::size_t AttributeCount() const noexcept override {
-            return DAttributes.size();
+    std::vector<std::thread> DWorkers;
+    std::mutex DMutex;
+    std::condition_variable DBatchReady;
+    std::condition_variable DQueueSpace;
+    std::deque<std::pair<std::size_t, std::unique_ptr<SBatch>>> DQueue;
+    std::size_t DMaxQueued;
+    std::vector<std::unique_ptr<SStore>> DChunks;
+    std::exception_ptr DException;
+    bool DDone = false;
+    std::unique_ptr<SBatch> DBatch = std::make_unique<SBatch>();
+    std::size_t DDepth = 0;
+
+    SParallelLoader(std::size_t workers) : DMaxQueued(workers * 2) {
+        for (std::size_t i = 0; i < workers; i++) {
+            DWorkers.emplace_back([this]() { Work(); });
         }
+    }
 
-        // Returns the key at the given index, or "" if invalid
-        std::string GetAttributeKey(std::size_t index) const noexcept override {
-            if (index >= DAttributes.size()) {
-                return "";
-            }
-            return DAttributes[index].first;
+    ~SParallelLoader() {
+        Stop();
+    }
+
+    void StartElement(const char *name, const char **attrs) override {
+        DBatch->StartElement(name, attrs);
+        DDepth++;
+    }
+
+    void EndElement(const char *name) override {
+        DBatch->EndElement(name);
+        DDepth--;
+        if (DDepth <= 1 && DBatch->DEvents.size() >= BatchEvents) {
+            Submit();
         }
+    }
 
-        // Checks if the key exists in attributes
-        bool HasAttribute(const std::string& key) const noexcept override {
-            for (const auto& attr : DAttributes) {
-                if (attr.first == key) {
-                    return true;
-                }
-            }
-            return false;
+    // Queues the current batch, waiting while the workers are behind
+    void Submit() {
+        std::unique_lock<std::mutex> lock(DMutex);
+        DQueueSpace.wait(lock, [this]() { return DQueue.size() < DMaxQueued || DException; });
+        if (DException) {
+            std::rethrow_exception(DException);
         }
+        DQueue.emplace_back(DChunks.size(), std::move(DBatch));
+        DChunks.emplace_back();
+        lock.unlock();
+        DBatchReady.notify_one();
+        DBatch = std::make_unique<SBatch>();
+    }
+
+    void Work() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(DMutex);
+            DBatchReady.wait(lock, [this]() { return !DQueue.empty() || DDone; });
+            if (DQueue.empty()) {
+                return;
+            }
+            auto item = std::move(DQueue.front());
+            DQueue.pop_front();
+            lock.unlock();
+            DQueueSpace.notify_one();
 
-        // Returns the value for the key, or "" if not found
-        std::string GetAttribute(const std::string& key) const noexcept override {
-            for (const auto& attr : DAttributes) {
-                if (attr.first == key) {
-                    return attr.second;
+            try {
+                auto chunk = std::make_unique<SStore>();
+                SParseHandler handler(*chunk);
+                item.second->Replay(handler);
+                item.second.reset();
+                lock.lock();
+                DChunks[item.first] = std::move(chunk);
+            } catch (...) {
+                if (!lock.owns_lock()) {
+                    lock.lock();
+                }
+                if (!DException) {
+                    DException = std::current_exception();
                 }
+                lock.unlock();
+                DQueueSpace.notify_all();
             }
-            return "";
-        }   
-    };
+        }
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(DMutex);
+            DDone = true;
+        }
+        DBatchReady.notify_all();
+        for (auto &worker : DWorkers) {
+            worker.join();
+        }
+        DWorkers.clear();
+    }
 
-    // COpenStreetMap variables
-    std::map<TNodeID, std::shared_ptr<Node>> DNodesById;
-    std::map<TWayID, std::shared_ptr<Way>> DWaysById;
-    std::vector<std::shared_ptr<Node>> DNodesOrdered;
-    std::vector<std::shared_ptr<Way>> DWaysOrdered;
+    // Waits for every batch and returns the chunk stores in file order
+    std::vector<std::unique_ptr<SStore>> Finish() {
+        if (!DBatch->DEvents.empty()) {
+            Submit();
+        }
+        Stop();
+        if (DException) {
+            std::rethrow_exception(DException);
+        }
+        return std::move(DChunks);
+    }
 };
 
 // Constructor: Initializes the OpenStreetMap from an XML source
-COpenStreetMap::COpenStreetMap(std::shared_ptr<CXMLReader> src) {
+COpenStreetMap::COpenStreetMap(std::shared_ptr<CXMLReader> src, std::size_t threads) {
     DImplementation = std::make_unique<SImplementation>();
-    SXMLEntity entity;
-
-    // process entities when ReadEnity() returns true 
-    while (src->ReadEntity(entity, true)) {
-        if (entity.DType == SXMLEntity::EType::StartElement) {
-            // handle Node case
-            if (entity.DNameData == "node") {
-                TNodeID id = std::stoull(entity.AttributeValue("id"));
-                double lat = std::stod(entity.AttributeValue("lat"));
-                double lon = std::stod(entity.AttributeValue("lon"));
-                std::vector<std::pair<std::string, std::string>> attrs;
-
-                // read the Node Elements (tag)
-                while (src->ReadEntity(entity, true) && 
-                       !(entity.DType == SXMLEntity::EType::EndElement && entity.DNameData == "node")) {
-                    if (entity.DType == SXMLEntity::EType::StartElement && entity.DNameData == "tag") {
-                        attrs.emplace_back(entity.AttributeValue("k"), entity.AttributeValue("v"));
-                    }
-                }
-
-                auto node = std::make_shared<SImplementation::Node>(id, TLocation{lat, lon}, attrs);
-                DImplementation->DNodesById[id] = node;
-                DImplementation->DNodesOrdered.push_back(node);
-            } 
-            // handle Way case
-            else if (entity.DNameData == "way") {
-                TWayID id = std::stoull(entity.AttributeValue("id"));
-                std::vector<TNodeID> nodeIds;
-                std::vector<std::pair<std::string, std::string>> attrs; 
-                // read the Way elements
-                while (src->ReadEntity(entity, true) && 
-                       !(entity.DType == SXMLEntity::EType::EndElement && entity.DNameData == "way")) {
-                    if (entity.DType == SXMLEntity::EType::StartElement) {
-                        if (entity.DNameData == "nd") {
-                            nodeIds.push_back(std::stoull(entity.AttributeValue("ref")));
-                        } else if (entity.DNameData == "tag") {
-                            attrs.emplace_back(entity.AttributeValue("k"), entity.AttributeValue("v"));
-                        }
-                    }
-                }
-
-                auto way = std::make_shared<SImplementation::Way>(id, nodeIds, attrs);
-                DImplementation->DWaysById[id] = way;
-                DImplementation->DWaysOrdered.push_back(way);
-            }  
+    // Relations, bounds and unused metadata are dropped inside the parser
+    src->AllowElements({"osm", "node", "way", "nd", "tag"});
+    src->AllowAttributes("node", {"id", "lat", "lon"});
+    src->AllowAttributes("way", {"id"});
+    src->AllowAttributes("nd", {"ref"});
+    src->AllowAttributes("tag", {"k", "v"});
+    if (!threads) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads > 1) {
+        SImplementation::SParallelLoader loader(threads - 1);
+        src->Parse(loader);
+        for (auto &chunk : loader.Finish()) {
+            DImplementation->DStore->Append(*chunk);
         }
+    } else {
+        SImplementation::SParseHandler handler(*DImplementation->DStore);
+        src->Parse(handler);
     }
+    DImplementation->DStore->Finish(threads);
 }
 
 
 // Destructor: Cleans up resources used by the OpenStreetMap
 COpenStreetMap::~COpenStreetMap() = default;
 
-// Returns the total number of nodes stored in the map, stored in DNodesById
+// Returns the number of distinct node IDs in the map
 std::size_t COpenStreetMap::NodeCount() const noexcept {
-    return DImplementation->DNodesById.size(); 
+    return DImplementation->DStore->DNodeIndex.size();
 }
 
-// Returns the total number of ways stored in the map, stored in DWaysById
+// Returns the number of distinct way IDs in the map
 std::size_t COpenStreetMap::WayCount() const noexcept {
-    return DImplementation->DWaysById.size(); 
+    return DImplementation->DStore->DWayIndex.size();
 }
 
-// Retrieves a shared pointer to the node at the specified index; returns nullptr if index is invalid
+// Retrieves a view of the node at the specified index; returns nullptr if index is invalid
 std::shared_ptr<CStreetMap::SNode> COpenStreetMap::NodeByIndex(std::size_t index) const noexcept {
-    if (index >= DImplementation->DNodesOrdered.size()) {
-        return nullptr;
-    }
-    return DImplementation->DNodesOrdered[index];
+    return SStreetMapStore::NodeByIndex(DImplementation->DStore, index);
 }
 
-// Retrieves a shared pointer to the node with the specified ID; returns nullptr if ID doesn't exist
+// Retrieves a view of the node with the specified ID; returns nullptr if ID doesn't exist
 std::shared_ptr<CStreetMap::SNode> COpenStreetMap::NodeByID(TNodeID id) const noexcept {
-    auto it = DImplementation->DNodesById.find(id);
-    if (it != DImplementation->DNodesById.end()) {
-        return it->second;
-    } else {
-        return nullptr;
-    }
+    return SStreetMapStore::NodeByID(DImplementation->DStore, id);
 }
-// Retrieves a shared pointer to the way at the specified index; returns nullptr if index is invalid
+
+// Retrieves a view of the way at the specified index; returns nullptr if index is invalid
 std::shared_ptr<CStreetMap::SWay> COpenStreetMap::WayByIndex(std::size_t index) const noexcept {
-    if (index >= DImplementation->DWaysOrdered.size()) {
-        return nullptr;
-    }
-    return DImplementation->DWaysOrdered[index];
+    return SStreetMapStore::WayByIndex(DImplementation->DStore, index);
 }
 
-// Retrieves a shared pointer to the way with the specified ID; returns nullptr if ID doesn't exist
+// Retrieves a view of the way with the specified ID; returns nullptr if ID doesn't exist
 std::shared_ptr<CStreetMap::SWay> COpenStreetMap::WayByID(TWayID id) const noexcept {
-    auto it = DImplementation->DWaysById.find(id);
-    if (it != DImplementation->DWaysById.end()) {
-        return it->second;
-    } else {
-        return nullptr;
-    }
-}
\ No newline at end of file
+    return SStreetMapStore::WayByID(DImplementation->DStore, id);
+}
+
+// Returns the interned ID of an attribute key or value, or InvalidAttributeID
+CStreetMap::TAttributeID COpenStreetMap::AttributeID(const std::string &str) const noexcept {
+    return DImplementation->DStore->Lookup(str);
+}
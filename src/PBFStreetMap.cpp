@@ -0,0 +1,512 @@
+#include "PBFStreetMap.h"
+#include "StreetMapStore.h"
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Cursor over an encoded protobuf message
+struct SProtoReader {
+    const uint8_t *DData;
+    const uint8_t *DEnd;
+
+    SProtoReader(const uint8_t *data, std::size_t size) : DData(data), DEnd(data + size) {}
+
+    static void Malformed() {
+        throw std::runtime_error("Malformed PBF data");
+    }
+
+    bool End() const {
+        return DData >= DEnd;
+    }
+
+    uint64_t Varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (DData >= DEnd) {
+                Malformed();
+            }
+            uint8_t byte = *DData++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        Malformed();
+        return 0;
+    }
+
+    static int64_t ZigZag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Reads the next field key, false at the end of the message
+    bool Next(uint32_t &field, uint32_t &wiretype) {
+        if (End()) {
+            return false;
+        }
+        uint64_t key = Varint();
+        field = static_cast<uint32_t>(key >> 3);
+        wiretype = static_cast<uint32_t>(key & 7);
+        return true;
+    }
+
+    SProtoReader Bytes() {
+        uint64_t size = Varint();
+        if (size > static_cast<uint64_t>(DEnd - DData)) {
+            Malformed();
+        }
+        SProtoReader bytes(DData, size);
+        DData += size;
+        return bytes;
+    }
+
+    std::string String() {
+        SProtoReader bytes = Bytes();
+        return std::string(reinterpret_cast<const char *>(bytes.DData), bytes.DEnd - bytes.DData);
+    }
+
+    void Skip(uint32_t wiretype) {
+        std::size_t size = 0;
+        switch (wiretype) {
+            case 0:
+                Varint();
+                return;
+            case 1:
+                size = 8;
+                break;
+            case 2:
+                Bytes();
+                return;
+            case 5:
+                size = 4;
+                break;
+            default:
+                Malformed();
+        }
+        if (size > static_cast<std::size_t>(DEnd - DData)) {
+            Malformed();
+        }
+        DData += size;
+    }
+
+    // Appends a repeated varint field, which encoders may write packed or
+    // one value per key
+    void Repeated(uint32_t wiretype, std::vector<uint64_t> &values) {
+        if (wiretype == 0) {
+            values.push_back(Varint());
+        } else if (wiretype == 2) {
+            SProtoReader packed = Bytes();
+            while (!packed.End()) {
+                values.push_back(packed.Varint());
+            }
+        } else {
+            Malformed();
+        }
+    }
+};
+
+// A framed blob of the file: its BlobHeader type and the Blob message
+struct SBlob {
+    std::string DType;
+    const uint8_t *DData;
+    std::size_t DSize;
+};
+
+// Splits the file into blobs using the length prefixed BlobHeaders
+std::vector<SBlob> ReadBlobs(const uint8_t *data, std::size_t size) {
+    std::vector<SBlob> blobs;
+    std::size_t position = 0;
+    while (position < size) {
+        if (size - position < 4) {
+            SProtoReader::Malformed();
+        }
+        std::size_t headerSize = (std::size_t(data[position]) << 24) | (std::size_t(data[position + 1]) << 16) |
+                                 (std::size_t(data[position + 2]) << 8) | std::size_t(data[position + 3]);
+        position += 4;
+        if (headerSize > size - position) {
+            SProtoReader::Malformed();
+        }
+        SProtoReader header(data + position, headerSize);
+        position += headerSize;
+
+        SBlob blob{"", nullptr, 0};
+        uint64_t blobSize = 0;
+        uint32_t field, wiretype;
+        while (header.Next(field, wiretype)) {
+            if (field == 1 && wiretype == 2) {
+                blob.DType = header.String();
+            } else if (field == 3 && wiretype == 0) {
+                blobSize = header.Varint();
+            } else {
+                header.Skip(wiretype);
+            }
+        }
+        if (blobSize > size - position) {
+            SProtoReader::Malformed();
+        }
+        blob.DData = data + position;
+        blob.DSize = blobSize;
+        position += blobSize;
+        blobs.push_back(blob);
+    }
+    return blobs;
+}
+
+// Returns the uncompressed contents of a Blob message
+SProtoReader BlobContents(const SBlob &blob, std::vector<uint8_t> &buffer) {
+    SProtoReader reader(blob.DData, blob.DSize);
+    SProtoReader raw(nullptr, 0), compressed(nullptr, 0);
+    bool haveRaw = false, haveCompressed = false;
+    uint64_t rawSize = 0;
+    uint32_t field, wiretype;
+    while (reader.Next(field, wiretype)) {
+        if (field == 1 && wiretype == 2) {
+            raw = reader.Bytes();
+            haveRaw = true;
+        } else if (field == 2 && wiretype == 0) {
+            rawSize = reader.Varint();
+        } else if (field == 3 && wiretype == 2) {
+            compressed = reader.Bytes();
+            haveCompressed = true;
+        } else if (field >= 4 && field <= 7) {
+            throw std::runtime_error("Unsupported PBF blob compression");
+        } else {
+            reader.Skip(wiretype);
+        }
+    }
+    if (haveRaw) {
+        return raw;
+    }
+    if (!haveCompressed) {
+        SProtoReader::Malformed();
+    }
+    buffer.resize(rawSize);
+    uLongf length = static_cast<uLongf>(rawSize);
+    if (uncompress(buffer.data(), &length, compressed.DData, static_cast<uLong>(compressed.DEnd - compressed.DData)) != Z_OK ||
+        length != rawSize) {
+        throw std::runtime_error("Corrupt zlib data in PBF blob");
+    }
+    return SProtoReader(buffer.data(), buffer.size());
+}
+
+// Rejects files that need features a street map cannot represent
+void CheckHeader(SProtoReader header) {
+    uint32_t field, wiretype;
+    while (header.Next(field, wiretype)) {
+        if (field == 4 && wiretype == 2) {
+            std::string feature = header.String();
+            if (feature != "OsmSchema-V0.6" && feature != "DenseNodes") {
+                throw std::runtime_error("Unsupported PBF feature: " + feature);
+            }
+        } else {
+            header.Skip(wiretype);
+        }
+    }
+}
+
+// Decodes one PrimitiveBlock, appending its nodes and ways to store
+class CBlockDecoder {
+    private:
+        SStreetMapStore &DStore;
+        std::vector<SProtoReader> DStrings;
+        std::vector<CStreetMap::TAttributeID> DStringIDs;
+        int64_t DGranularity = 100;
+        int64_t DLatOffset = 0;
+        int64_t DLonOffset = 0;
+        std::vector<uint64_t> DKeys, DValues, DIDs, DLats, DLons, DKeyValues, DRefs;
+
+        CStreetMap::TAttributeID StringID(uint64_t index) {
+            if (index >= DStrings.size()) {
+                SProtoReader::Malformed();
+            }
+            if (DStringIDs[index] == CStreetMap::InvalidAttributeID) {
+                const SProtoReader &str = DStrings[index];
+                DStringIDs[index] = DStore.Intern(std::string(reinterpret_cast<const char *>(str.DData), str.DEnd - str.DData));
+            }
+            return DStringIDs[index];
+        }
+
+        double Coordinate(int64_t offset, int64_t value) const {
+            return 1e-9 * static_cast<double>(offset + DGranularity * value);
+        }
+
+        void AddAttributes(std::vector<SStreetMapStore::TAttribute> &attributes) {
+            if (DKeys.size() != DValues.size()) {
+                SProtoReader::Malformed();
+            }
+            for (std::size_t i = 0; i < DKeys.size(); i++) {
+                attributes.emplace_back(StringID(DKeys[i]), StringID(DValues[i]));
+            }
+        }
+
+        void DecodeNode(SProtoReader node) {
+            int64_t id = 0, lat = 0, lon = 0;
+            DKeys.clear();
+            DValues.clear();
+            uint32_t field, wiretype;
+            while (node.Next(field, wiretype)) {
+                if (field == 1 && wiretype == 0) {
+                    id = SProtoReader::ZigZag(node.Varint());
+                } else if (field == 2) {
+                    node.Repeated(wiretype, DKeys);
+                } else if (field == 3) {
+                    node.Repeated(wiretype, DValues);
+                } else if (field == 8 && wiretype == 0) {
+                    lat = SProtoReader::ZigZag(node.Varint());
+                } else if (field == 9 && wiretype == 0) {
+                    lon = SProtoReader::ZigZag(node.Varint());
+                } else {
+                    node.Skip(wiretype);
+                }
+            }
+            DStore.AddNode(static_cast<CStreetMap::TNodeID>(id), {Coordinate(DLatOffset, lat), Coordinate(DLonOffset, lon)});
+            AddAttributes(DStore.DNodeAttributes);
+        }
+
+        // Dense nodes store delta coded columns, and the tags of every node
+        // as key/value string indices each list ended by a 0
+        void DecodeDenseNodes(SProtoReader dense) {
+            DIDs.clear();
+            DLats.clear();
+            DLons.clear();
+            DKeyValues.clear();
+            uint32_t field, wiretype;
+            while (dense.Next(field, wiretype)) {
+                if (field == 1) {
+                    dense.Repeated(wiretype, DIDs);
+                } else if (field == 8) {
+                    dense.Repeated(wiretype, DLats);
+                } else if (field == 9) {
+                    dense.Repeated(wiretype, DLons);
+                } else if (field == 10) {
+                    dense.Repeated(wiretype, DKeyValues);
+                } else {
+                    dense.Skip(wiretype);
+                }
+            }
+            if (DLats.size() != DIDs.size() || DLons.size() != DIDs.size()) {
+                SProtoReader::Malformed();
+            }
+            int64_t id = 0, lat = 0, lon = 0;
+            std::size_t keyValue = 0;
+            for (std::size_t i = 0; i < DIDs.size(); i++) {
+                id += SProtoReader::ZigZag(DIDs[i]);
+                lat += SProtoReader::ZigZag(DLats[i]);
+                lon += SProtoReader::ZigZag(DLons[i]);
+                DStore.AddNode(static_cast<CStreetMap::TNodeID>(id), {Coordinate(DLatOffset, lat), Coordinate(DLonOffset, lon)});
+                while (keyValue < DKeyValues.size() && DKeyValues[keyValue]) {
+                    if (keyValue + 1 >= DKeyValues.size()) {
+                        SProtoReader::Malformed();
+                    }
+                    DStore.DNodeAttributes.emplace_back(StringID(DKeyValues[keyValue]), StringID(DKeyValues[keyValue + 1]));
+                    keyValue += 2;
+                }
+                keyValue++;
+            }
+        }
+
+        void DecodeWay(SProtoReader way) {
+            uint64_t id = 0;
+            DKeys.clear();
+            DValues.clear();
+            DRefs.clear();
+            uint32_t field, wiretype;
+            while (way.Next(field, wiretype)) {
+                if (field == 1 && wiretype == 0) {
+                    id = way.Varint();
+                } else if (field == 2) {
+                    way.Repeated(wiretype, DKeys);
+                } else if (field == 3) {
+                    way.Repeated(wiretype, DValues);
+                } else if (field == 8) {
+                    way.Repeated(wiretype, DRefs);
+                } else {
+                    way.Skip(wiretype);
+                }
+            }
+            DStore.AddWay(id);
+            int64_t ref = 0;
+            for (auto delta : DRefs) {
+                ref += SProtoReader::ZigZag(delta);
+                DStore.DWayNodeIDs.push_back(static_cast<CStreetMap::TNodeID>(ref));
+            }
+            AddAttributes(DStore.DWayAttributes);
+        }
+
+        void DecodeGroup(SProtoReader group) {
+            uint32_t field, wiretype;
+            while (group.Next(field, wiretype)) {
+                if (field == 1 && wiretype == 2) {
+                    DecodeNode(group.Bytes());
+                } else if (field == 2 && wiretype == 2) {
+                    DecodeDenseNodes(group.Bytes());
+                } else if (field == 3 && wiretype == 2) {
+                    DecodeWay(group.Bytes());
+                } else {
+                    group.Skip(wiretype);
+                }
+            }
+        }
+
+    public:
+        CBlockDecoder(SStreetMapStore &store) : DStore(store) {}
+
+        void Decode(SProtoReader block) {
+            // The string table and scaling fields may follow the groups
+            std::vector<SProtoReader> groups;
+            uint32_t field, wiretype;
+            while (block.Next(field, wiretype)) {
+                if (field == 1 && wiretype == 2) {
+                    SProtoReader table = block.Bytes();
+                    while (table.Next(field, wiretype)) {
+                        if (field == 1 && wiretype == 2) {
+                            DStrings.push_back(table.Bytes());
+                        } else {
+                            table.Skip(wiretype);
+                        }
+                    }
+                } else if (field == 2 && wiretype == 2) {
+                    groups.push_back(block.Bytes());
+                } else if (field == 17 && wiretype == 0) {
+                    DGranularity = static_cast<int64_t>(block.Varint());
+                } else if (field == 19 && wiretype == 0) {
+                    DLatOffset = static_cast<int64_t>(block.Varint());
+                } else if (field == 20 && wiretype == 0) {
+                    DLonOffset = static_cast<int64_t>(block.Varint());
+                } else {
+                    block.Skip(wiretype);
+                }
+            }
+            DStringIDs.assign(DStrings.size(), CStreetMap::TAttributeID(CStreetMap::InvalidAttributeID));
+            for (auto &group : groups) {
+                DecodeGroup(group);
+            }
+        }
+};
+
+void DecodeBlob(const SBlob &blob, SStreetMapStore &store) {
+    std::vector<uint8_t> buffer;
+    SProtoReader contents = BlobContents(blob, buffer);
+    if (blob.DType == "OSMHeader") {
+        CheckHeader(contents);
+    } else if (blob.DType == "OSMData") {
+        CBlockDecoder(store).Decode(contents);
+    }
+}
+
+}
+
+struct CPBFStreetMap::SImplementation {
+    std::shared_ptr<SStreetMapStore> DStore = std::make_shared<SStreetMapStore>();
+
+    // Decodes the blobs on worker threads into one store per blob, then
+    // appends them in file order
+    void DecodeParallel(const std::vector<SBlob> &blobs, std::size_t threads) {
+        std::vector<std::unique_ptr<SStreetMapStore>> chunks(blobs.size());
+        std::vector<std::exception_ptr> errors(blobs.size());
+        std::atomic<std::size_t> nextBlob(0);
+        auto work = [&]() {
+            std::size_t index;
+            while ((index = nextBlob++) < blobs.size()) {
+                try {
+                    chunks[index] = std::make_unique<SStreetMapStore>();
+                    DecodeBlob(blobs[index], *chunks[index]);
+                } catch (...) {
+                    errors[index] = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < std::min(threads, blobs.size()); i++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        for (std::size_t i = 0; i < blobs.size(); i++) {
+            if (errors[i]) {
+                std::rethrow_exception(errors[i]);
+            }
+            DStore->Append(*chunks[i]);
+            chunks[i].reset();
+        }
+    }
+};
+
+CPBFStreetMap::CPBFStreetMap(std::shared_ptr<CDataSource> src, std::size_t threads) {
+    DImplementation = std::make_unique<SImplementation>();
+
+    // Decode straight from the borrowed region when it holds the whole
+    // source, otherwise gather the source into a buffer first
+    const char *data = nullptr;
+    std::size_t size = 0;
+    std::vector<char> buffer;
+    if (src->Borrow(data, size)) {
+        src->Consume(size);
+        if (!src->End()) {
+            buffer.assign(data, data + size);
+            while (src->Borrow(data, size)) {
+                buffer.insert(buffer.end(), data, data + size);
+                src->Consume(size);
+            }
+            data = buffer.data();
+            size = buffer.size();
+        }
+    }
+
+    auto blobs = ReadBlobs(reinterpret_cast<const uint8_t *>(data), size);
+    if (!threads) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads > 1 && blobs.size() > 1) {
+        DImplementation->DecodeParallel(blobs, threads);
+    } else {
+        for (auto &blob : blobs) {
+            DecodeBlob(blob, *DImplementation->DStore);
+        }
+    }
+    DImplementation->DStore->Finish(threads);
+}
+
+CPBFStreetMap::~CPBFStreetMap() = default;
+
+// Returns the number of distinct node IDs in the map
+std::size_t CPBFStreetMap::NodeCount() const noexcept {
+    return DImplementation->DStore->DNodeIndex.size();
+}
+
+// Returns the number of distinct way IDs in the map
+std::size_t CPBFStreetMap::WayCount() const noexcept {
+    return DImplementation->DStore->DWayIndex.size();
+}
+
+std::shared_ptr<CStreetMap::SNode> CPBFStreetMap::NodeByIndex(std::size_t index) const noexcept {
+    return SStreetMapStore::NodeByIndex(DImplementation->DStore, index);
+}
+
+std::shared_ptr<CStreetMap::SNode> CPBFStreetMap::NodeByID(TNodeID id) const noexcept {
+    return SStreetMapStore::NodeByID(DImplementation->DStore, id);
+}
+
+std::shared_ptr<CStreetMap::SWay> CPBFStreetMap::WayByIndex(std::size_t index) const noexcept {
+    return SStreetMapStore::WayByIndex(DImplementation->DStore, index);
+}
+
+std::shared_ptr<CStreetMap::SWay> CPBFStreetMap::WayByID(TWayID id) const noexcept {
+    return SStreetMapStore::WayByID(DImplementation->DStore, id);
+}
+
+CStreetMap::TAttributeID CPBFStreetMap::AttributeID(const std::string &str) const noexcept {
+    return DImplementation->DStore->Lookup(str);
+}
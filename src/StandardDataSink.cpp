@@ -7,6 +7,15 @@ bool CStandardDataSink::Put(const char &ch) noexcept{
 }
 
 bool CStandardDataSink::Write(const std::vector<char> &buf) noexcept{
-    std::cout.write(buf.data(),buf.size());
+    return Write(buf.data(),buf.size());
+}
+
+bool CStandardDataSink::Write(const char *data, std::size_t size) noexcept{
+    std::cout.write(data,size);
+    return std::cout.good();
+}
+
+bool CStandardDataSink::Flush() noexcept{
+    std::cout.flush();
     return std::cout.good();
-}
\ No newline at end of file
+}
@@ -7,6 +7,15 @@ bool CStandardErrorDataSink::Put(const char &ch) noexcept{
 }
 
 bool CStandardErrorDataSink::Write(const std::vector<char> &buf) noexcept{
-    std::cerr.write(buf.data(),buf.size());
+    return Write(buf.data(),buf.size());
+}
+
+bool CStandardErrorDataSink::Write(const char *data, std::size_t size) noexcept{
+    std::cerr.write(data,size);
+    return std::cerr.good();
+}
+
+bool CStandardErrorDataSink::Flush() noexcept{
+    std::cerr.flush();
     return std::cerr.good();
-}
\ No newline at end of file
+}
@@ -0,0 +1,283 @@
+#include "StreetMapStore.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+using TAttribute = SStreetMapStore::TAttribute;
+using TAttributeID = SStreetMapStore::TAttributeID;
+
+// Looks up the element index stored for id
+template <typename TID>
+bool FindIndex(const std::vector<std::pair<TID, std::size_t>> &index, TID id, std::size_t &position) {
+    auto search = std::lower_bound(index.begin(), index.end(), id,
+                                   [](const std::pair<TID, std::size_t> &entry, TID value) { return entry.first < value; });
+    if (search == index.end() || search->first != id) {
+        return false;
+    }
+    position = search->second;
+    return true;
+}
+
+// Sorts the ids and keeps the last index for any repeated id
+template <typename TID>
+void BuildIndex(const std::vector<TID> &ids, std::vector<std::pair<TID, std::size_t>> &index) {
+    index.resize(ids.size());
+    for (std::size_t i = 0; i < ids.size(); i++) {
+        index[i] = {ids[i], i};
+    }
+    std::sort(index.begin(), index.end());
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < index.size(); i++) {
+        if (kept && index[kept - 1].first == index[i].first) {
+            index[kept - 1] = index[i];
+        } else {
+            index[kept++] = index[i];
+        }
+    }
+    index.resize(kept);
+}
+
+std::string AttributeKey(const SStreetMapStore &store, const TAttribute *begin, const TAttribute *end, std::size_t index) {
+    if (index >= static_cast<std::size_t>(end - begin)) {
+        return "";
+    }
+    return *store.DStrings[begin[index].first];
+}
+
+// Returns the value ID stored for the key ID, or InvalidAttributeID
+TAttributeID FindAttribute(const TAttribute *begin, const TAttribute *end, TAttributeID key) noexcept {
+    for (auto attr = begin; attr != end; ++attr) {
+        if (attr->first == key) {
+            return attr->second;
+        }
+    }
+    return CStreetMap::InvalidAttributeID;
+}
+
+bool HasAttribute(const SStreetMapStore &store, const TAttribute *begin, const TAttribute *end, const std::string &key) noexcept {
+    TAttributeID id = store.Lookup(key);
+    return id != CStreetMap::InvalidAttributeID && FindAttribute(begin, end, id) != CStreetMap::InvalidAttributeID;
+}
+
+std::string GetAttribute(const SStreetMapStore &store, const TAttribute *begin, const TAttribute *end, const std::string &key) noexcept {
+    TAttributeID id = store.Lookup(key);
+    if (id == CStreetMap::InvalidAttributeID) {
+        return "";
+    }
+    id = FindAttribute(begin, end, id);
+    return id == CStreetMap::InvalidAttributeID ? "" : *store.DStrings[id];
+}
+
+const TAttribute *NodeAttributesBegin(const SStreetMapStore &store, std::size_t index) noexcept {
+    return store.DNodeAttributes.data() + store.DNodeAttributeOffsets[index];
+}
+
+const TAttribute *NodeAttributesEnd(const SStreetMapStore &store, std::size_t index) noexcept {
+    return store.DNodeAttributes.data() + store.DNodeAttributeOffsets[index + 1];
+}
+
+const TAttribute *WayAttributesBegin(const SStreetMapStore &store, std::size_t index) noexcept {
+    return store.DWayAttributes.data() + store.DWayAttributeOffsets[index];
+}
+
+const TAttribute *WayAttributesEnd(const SStreetMapStore &store, std::size_t index) noexcept {
+    return store.DWayAttributes.data() + store.DWayAttributeOffsets[index + 1];
+}
+
+}
+
+// Returns the node's ID
+SStreetMapStore::TNodeID SStreetMapStore::SNodeView::ID() const noexcept {
+    return DStore->DNodeIDs[DIndex];
+}
+
+// Returns the node's location (lat, lon)
+SStreetMapStore::TLocation SStreetMapStore::SNodeView::Location() const noexcept {
+    return DStore->DNodeLocations[DIndex];
+}
+
+// Returns the number of attributes
+std::size_t SStreetMapStore::SNodeView::AttributeCount() const noexcept {
+    return NodeAttributesEnd(*DStore, DIndex) - NodeAttributesBegin(*DStore, DIndex);
+}
+
+// Returns the key at the given index, or "" if invalid
+std::string SStreetMapStore::SNodeView::GetAttributeKey(std::size_t index) const noexcept {
+    return AttributeKey(*DStore, NodeAttributesBegin(*DStore, DIndex), NodeAttributesEnd(*DStore, DIndex), index);
+}
+
+// Checks if the key exists in attributes
+bool SStreetMapStore::SNodeView::HasAttribute(const std::string &key) const noexcept {
+    return ::HasAttribute(*DStore, NodeAttributesBegin(*DStore, DIndex), NodeAttributesEnd(*DStore, DIndex), key);
+}
+
+// Returns the value for the key, or "" if not found
+std::string SStreetMapStore::SNodeView::GetAttribute(const std::string &key) const noexcept {
+    return ::GetAttribute(*DStore, NodeAttributesBegin(*DStore, DIndex), NodeAttributesEnd(*DStore, DIndex), key);
+}
+
+// Returns the value ID for the key ID, or InvalidAttributeID
+SStreetMapStore::TAttributeID SStreetMapStore::SNodeView::GetAttributeID(TAttributeID key) const noexcept {
+    return FindAttribute(NodeAttributesBegin(*DStore, DIndex), NodeAttributesEnd(*DStore, DIndex), key);
+}
+
+// Returns the way's ID
+SStreetMapStore::TWayID SStreetMapStore::SWayView::ID() const noexcept {
+    return DStore->DWayIDs[DIndex];
+}
+
+// Returns the number of nodes in the way
+std::size_t SStreetMapStore::SWayView::NodeCount() const noexcept {
+    return DStore->DWayNodeOffsets[DIndex + 1] - DStore->DWayNodeOffsets[DIndex];
+}
+
+// Returns the node ID at the given index, or InvalidNodeID if invalid
+SStreetMapStore::TNodeID SStreetMapStore::SWayView::GetNodeID(std::size_t index) const noexcept {
+    if (index >= NodeCount()) {
+        return CStreetMap::InvalidNodeID;  // Defined as max uint64_t
+    }
+    return DStore->DWayNodeIDs[DStore->DWayNodeOffsets[DIndex] + index];
+}
+
+// Returns the number of attributes
+std::size_t SStreetMapStore::SWayView::AttributeCount() const noexcept {
+    return WayAttributesEnd(*DStore, DIndex) - WayAttributesBegin(*DStore, DIndex);
+}
+
+// Returns the key at the given index, or "" if invalid
+std::string SStreetMapStore::SWayView::GetAttributeKey(std::size_t index) const noexcept {
+    return AttributeKey(*DStore, WayAttributesBegin(*DStore, DIndex), WayAttributesEnd(*DStore, DIndex), index);
+}
+
+// Checks if the key exists in attributes
+bool SStreetMapStore::SWayView::HasAttribute(const std::string &key) const noexcept {
+    return ::HasAttribute(*DStore, WayAttributesBegin(*DStore, DIndex), WayAttributesEnd(*DStore, DIndex), key);
+}
+
+// Returns the value for the key, or "" if not found
+std::string SStreetMapStore::SWayView::GetAttribute(const std::string &key) const noexcept {
+    return ::GetAttribute(*DStore, WayAttributesBegin(*DStore, DIndex), WayAttributesEnd(*DStore, DIndex), key);
+}
+
+// Returns the value ID for the key ID, or InvalidAttributeID
+SStreetMapStore::TAttributeID SStreetMapStore::SWayView::GetAttributeID(TAttributeID key) const noexcept {
+    return FindAttribute(WayAttributesBegin(*DStore, DIndex), WayAttributesEnd(*DStore, DIndex), key);
+}
+
+SStreetMapStore::TAttributeID SStreetMapStore::Intern(const std::string &str) {
+    auto search = DStringIDs.find(str);
+    if (search != DStringIDs.end()) {
+        return search->second;
+    }
+    auto id = static_cast<TAttributeID>(DStrings.size());
+    DStrings.push_back(&DStringIDs.emplace(str, id).first->first);
+    return id;
+}
+
+SStreetMapStore::TAttributeID SStreetMapStore::Lookup(const std::string &str) const noexcept {
+    auto search = DStringIDs.find(str);
+    return search == DStringIDs.end() ? CStreetMap::InvalidAttributeID : search->second;
+}
+
+void SStreetMapStore::AddNode(TNodeID id, TLocation location) {
+    DNodeIDs.push_back(id);
+    DNodeLocations.push_back(location);
+    DNodeAttributeOffsets.push_back(DNodeAttributes.size());
+}
+
+void SStreetMapStore::AddWay(TWayID id) {
+    DWayIDs.push_back(id);
+    DWayNodeOffsets.push_back(DWayNodeIDs.size());
+    DWayAttributeOffsets.push_back(DWayAttributes.size());
+}
+
+void SStreetMapStore::Append(const SStreetMapStore &chunk) {
+    std::vector<TAttributeID> remap(chunk.DStrings.size());
+    for (std::size_t i = 0; i < remap.size(); i++) {
+        remap[i] = Intern(*chunk.DStrings[i]);
+    }
+    std::size_t base = DNodeAttributes.size();
+    DNodeIDs.insert(DNodeIDs.end(), chunk.DNodeIDs.begin(), chunk.DNodeIDs.end());
+    DNodeLocations.insert(DNodeLocations.end(), chunk.DNodeLocations.begin(), chunk.DNodeLocations.end());
+    for (auto offset : chunk.DNodeAttributeOffsets) {
+        DNodeAttributeOffsets.push_back(base + offset);
+    }
+    for (auto &attr : chunk.DNodeAttributes) {
+        DNodeAttributes.emplace_back(remap[attr.first], remap[attr.second]);
+    }
+
+    base = DWayNodeIDs.size();
+    DWayIDs.insert(DWayIDs.end(), chunk.DWayIDs.begin(), chunk.DWayIDs.end());
+    for (auto offset : chunk.DWayNodeOffsets) {
+        DWayNodeOffsets.push_back(base + offset);
+    }
+    DWayNodeIDs.insert(DWayNodeIDs.end(), chunk.DWayNodeIDs.begin(), chunk.DWayNodeIDs.end());
+    base = DWayAttributes.size();
+    for (auto offset : chunk.DWayAttributeOffsets) {
+        DWayAttributeOffsets.push_back(base + offset);
+    }
+    for (auto &attr : chunk.DWayAttributes) {
+        DWayAttributes.emplace_back(remap[attr.first], remap[attr.second]);
+    }
+}
+
+void SStreetMapStore::Finish(std::size_t threads) {
+    DNodeAttributeOffsets.push_back(DNodeAttributes.size());
+    DWayNodeOffsets.push_back(DWayNodeIDs.size());
+    DWayAttributeOffsets.push_back(DWayAttributes.size());
+
+    auto buildWays = [this]() {
+        DWayViews.reserve(DWayIDs.size());
+        for (std::size_t i = 0; i < DWayIDs.size(); i++) {
+            DWayViews.emplace_back(this, i);
+        }
+        BuildIndex(DWayIDs, DWayIndex);
+    };
+    std::thread wayThread;
+    if (threads > 1) {
+        wayThread = std::thread(buildWays);
+    }
+    DNodeViews.reserve(DNodeIDs.size());
+    for (std::size_t i = 0; i < DNodeIDs.size(); i++) {
+        DNodeViews.emplace_back(this, i);
+    }
+    BuildIndex(DNodeIDs, DNodeIndex);
+    if (wayThread.joinable()) {
+        wayThread.join();
+    } else {
+        buildWays();
+    }
+}
+
+// Views are handed out through the aliasing constructor, so they share the
+// store's ownership without allocating
+std::shared_ptr<CStreetMap::SNode> SStreetMapStore::NodeByIndex(const std::shared_ptr<SStreetMapStore> &store, std::size_t index) noexcept {
+    if (index >= store->DNodeViews.size()) {
+        return nullptr;
+    }
+    return std::shared_ptr<CStreetMap::SNode>(store, &store->DNodeViews[index]);
+}
+
+std::shared_ptr<CStreetMap::SNode> SStreetMapStore::NodeByID(const std::shared_ptr<SStreetMapStore> &store, TNodeID id) noexcept {
+    std::size_t index;
+    if (!FindIndex(store->DNodeIndex, id, index)) {
+        return nullptr;
+    }
+    return std::shared_ptr<CStreetMap::SNode>(store, &store->DNodeViews[index]);
+}
+
+std::shared_ptr<CStreetMap::SWay> SStreetMapStore::WayByIndex(const std::shared_ptr<SStreetMapStore> &store, std::size_t index) noexcept {
+    if (index >= store->DWayViews.size()) {
+        return nullptr;
+    }
+    return std::shared_ptr<CStreetMap::SWay>(store, &store->DWayViews[index]);
+}
+
+std::shared_ptr<CStreetMap::SWay> SStreetMapStore::WayByID(const std::shared_ptr<SStreetMapStore> &store, TWayID id) noexcept {
+    std::size_t index;
+    if (!FindIndex(store->DWayIndex, id, index)) {
+        return nullptr;
+    }
+    return std::shared_ptr<CStreetMap::SWay>(store, &store->DWayViews[index]);
+}
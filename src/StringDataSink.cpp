@@ -5,11 +5,15 @@ const std::string &CStringDataSink::String() const{
 }
 
 bool CStringDataSink::Put(const char &ch) noexcept{
-    DString += std::string(1,ch);
+    DString.push_back(ch);
     return true;
 }
 
 bool CStringDataSink::Write(const std::vector<char> &buf) noexcept{
-    DString += std::string(buf.data(),buf.size());
+    return Write(buf.data(),buf.size());
+}
+
+bool CStringDataSink::Write(const char *data, std::size_t size) noexcept{
+    DString.append(data,size);
     return true;
 }
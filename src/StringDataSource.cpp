@@ -1,4 +1,5 @@
 #include "StringDataSource.h"
+#include <algorithm>
 
 CStringDataSource::CStringDataSource(const std::string &str) : DString(str), DIndex(0){
 
@@ -38,3 +39,16 @@ bool CStringDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept
     }
     return !buf.empty();
 }
+
+bool CStringDataSource::Borrow(const char *&data, std::size_t &size) noexcept{
+    if(DIndex >= DString.length()){
+        return false;
+    }
+    data = DString.data() + DIndex;
+    size = DString.length() - DIndex;
+    return true;
+}
+
+void CStringDataSource::Consume(std::size_t count) noexcept{
+    DIndex = std::min(DIndex + count, DString.length());
+}
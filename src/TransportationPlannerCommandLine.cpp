@@ -35,6 +35,9 @@ struct CTransportationPlannerCommandLine::SImplementation {
     }
 
     bool ReadLine(std::string& line) {
+        // Everything written so far must be visible before waiting on input
+        outSink->Flush();
+        errSink->Flush();
         line.clear();
         char ch;
         while (!cmdSource->End()) {
@@ -46,10 +49,10 @@ struct CTransportationPlannerCommandLine::SImplementation {
     }
 
     bool WriteLine(std::shared_ptr<CDataSink> sink, const std::string& line) {
-        for (char ch : line) {
-            if (!sink->Put(ch)) return false;
-        }
-        return sink->Put('\n');
+        std::string output;
+        output.reserve(line.size() + 1);
+        output.append(line).push_back('\n');
+        return sink->Write(output.data(), output.size());
     }
     
     // Helper method to find a node by ID
@@ -5,13 +5,36 @@
 #include <memory>
 #include <vector>
 #include <stdexcept>
+#include <algorithm>
+#include <exception>
+#include <cstring>
 
 struct CXMLReader::SImplementation {
+    static constexpr std::size_t ParseChunkSize = 4096;
+
     std::shared_ptr<CDataSource> DSource;
     XML_Parser DParser;
     bool ifend;
+    // Ring buffer of parsed entities. Popped slots take the caller's old
+    // entity so their strings and attribute vector are reused on later pushes.
     std::vector<SXMLEntity> enQue;
+    std::size_t QueueHead = 0;
+    std::size_t QueueSize = 0;
     std::string CharDataBuffer;
+    // Set while Parse is running; events bypass the queue and go here
+    SHandler *DHandler = nullptr;
+    std::exception_ptr DHandlerException;
+
+    // Element and attribute allow-lists, empty when everything is allowed
+    struct SAttributeFilter {
+        std::string DElement;
+        std::vector<std::string> DAttributes;
+    };
+    std::vector<std::string> AllowedElements;
+    std::vector<SAttributeFilter> AttributeFilters;
+    std::vector<const char *> FilteredAttributes;
+    // Depth inside a dropped element, zero when not skipping
+    std::size_t SkipDepth = 0;
 
     SImplementation(std::shared_ptr<CDataSource> src) 
         : DSource(std::move(src)), ifend(false) {
@@ -31,36 +54,59 @@ struct CXMLReader::SImplementation {
     }
 
     bool End() const {
-        return ifend && enQue.empty();
+        return ifend && QueueSize == 0;
+    }
+
+    // Feed the parser the next borrowed region of the source
+    void ParseNext() {
+        const char *Data;
+        std::size_t Size;
+        if (!DSource->Borrow(Data, Size)) {
+            FinishParse();
+            return;
+        }
+        
+        // Parse the borrowed region in place, a chunk at a time so the
+        // entity queue stays small
+        Size = std::min(Size, ParseChunkSize);
+        CheckStatus(XML_Parse(DParser, Data, static_cast<int>(Size), 0));
+        DSource->Consume(Size);
+        
+        if (DSource->End()) {
+            FinishParse();
+        }
+    }
+
+    // Tell expat the input is over so it delivers the tokens it held back
+    void FinishParse() {
+        ifend = true;
+        CheckStatus(XML_Parse(DParser, nullptr, 0, 1));
+        FlushCharData(this);
+    }
+
+    // Rethrow a handler exception, or report a parse error
+    void CheckStatus(XML_Status status) {
+        if (DHandlerException) {
+            std::exception_ptr Exception = DHandlerException;
+            DHandlerException = nullptr;
+            std::rethrow_exception(Exception);
+        }
+        if (status == XML_STATUS_ERROR) {
+            throw std::runtime_error(XML_ErrorString(XML_GetErrorCode(DParser)));
+        }
     }
 
     bool ReadEntity(SXMLEntity &entity, bool skipdata) {
         // Parse more data if the queue is empty
-        while (enQue.empty() && !ifend) {
-            std::vector<char> Buffer(4096);
-            if (!DSource->Read(Buffer, Buffer.size())) {
-                ifend = true;
-                if (XML_Parse(DParser, nullptr, 0, 1) == XML_STATUS_ERROR) {
-                    throw std::runtime_error(XML_ErrorString(XML_GetErrorCode(DParser)));
-                }
-                FlushCharData(this);
-                break;
-            }
-            
-            size_t rsize = Buffer.size();
-            if (XML_Parse(DParser, Buffer.data(), static_cast<int>(rsize), 0) == XML_STATUS_ERROR) {
-                throw std::runtime_error(XML_ErrorString(XML_GetErrorCode(DParser)));
-            }
-            
-            if (DSource->End()) {
-                ifend = true;
-            }
+        while (QueueSize == 0 && !ifend) {
+            ParseNext();
         }
 
         // Return the next entity (skip character data if requested)
-        while (!enQue.empty()) {
-            entity = std::move(enQue.front());
-            enQue.erase(enQue.begin());
+        while (QueueSize) {
+            std::swap(entity, enQue[QueueHead]);
+            QueueHead = (QueueHead + 1) % enQue.size();
+            QueueSize--;
             
             if (skipdata && entity.DType == SXMLEntity::EType::CharData) {
                 continue;
@@ -70,6 +116,106 @@ struct CXMLReader::SImplementation {
         return false;
     }
 
+    bool Parse(SHandler &handler) {
+        if (End()) {
+            return false;
+        }
+        // Deliver whatever ReadEntity already queued before going direct
+        FlushCharData(this);
+        SXMLEntity Entity;
+        std::vector<const char *> Attributes;
+        while (QueueSize && ReadEntity(Entity, false)) {
+            if (Entity.DType == SXMLEntity::EType::StartElement) {
+                Attributes.clear();
+                for (auto &Attribute : Entity.DAttributes) {
+                    Attributes.push_back(Attribute.first.c_str());
+                    Attributes.push_back(Attribute.second.c_str());
+                }
+                Attributes.push_back(nullptr);
+                handler.StartElement(Entity.DNameData.c_str(), Attributes.data());
+            } else if (Entity.DType == SXMLEntity::EType::EndElement) {
+                handler.EndElement(Entity.DNameData.c_str());
+            } else {
+                handler.CharData(Entity.DNameData.data(), Entity.DNameData.size());
+            }
+        }
+
+        DHandler = &handler;
+        try {
+            while (!ifend) {
+                ParseNext();
+            }
+        } catch (...) {
+            DHandler = nullptr;
+            throw;
+        }
+        DHandler = nullptr;
+        return true;
+    }
+
+    static bool Listed(const std::vector<std::string> &names, const char *name) {
+        for (auto &Name : names) {
+            if (std::strcmp(Name.c_str(), name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ElementAllowed(const char *name) const {
+        return AllowedElements.empty() || Listed(AllowedElements, name);
+    }
+
+    // Returns the attributes of the element that pass its allow-list
+    const char **FilterAttributes(const char *name, const char **attrs) {
+        for (auto &Filter : AttributeFilters) {
+            if (std::strcmp(Filter.DElement.c_str(), name) == 0) {
+                FilteredAttributes.clear();
+                for (int i = 0; attrs && attrs[i]; i += 2) {
+                    if (Listed(Filter.DAttributes, attrs[i])) {
+                        FilteredAttributes.push_back(attrs[i]);
+                        FilteredAttributes.push_back(attrs[i + 1]);
+                    }
+                }
+                FilteredAttributes.push_back(nullptr);
+                return FilteredAttributes.data();
+            }
+        }
+        return attrs;
+    }
+
+    // Run a handler callback, stopping the parser if it throws so the
+    // exception never unwinds through expat
+    template <typename TCallback>
+    static void Dispatch(SImplementation *impl, TCallback callback) {
+        if (impl->DHandlerException) {
+            return;
+        }
+        try {
+            callback(*impl->DHandler);
+        } catch (...) {
+            impl->DHandlerException = std::current_exception();
+            XML_StopParser(impl->DParser, XML_FALSE);
+        }
+    }
+
+    // Claim the slot at the back of the queue, growing it when full
+    SXMLEntity &PushEntity(SXMLEntity::EType type, const char *name) {
+        if (QueueSize == enQue.size()) {
+            std::vector<SXMLEntity> Grown(std::max<std::size_t>(16, enQue.size() * 2));
+            for (std::size_t Index = 0; Index < QueueSize; Index++) {
+                std::swap(Grown[Index], enQue[(QueueHead + Index) % enQue.size()]);
+            }
+            enQue.swap(Grown);
+            QueueHead = 0;
+        }
+        SXMLEntity &Entity = enQue[(QueueHead + QueueSize) % enQue.size()];
+        QueueSize++;
+        Entity.DType = type;
+        Entity.DNameData.assign(name);
+        return Entity;
+    }
+
     // Flush any accumulated character data into an entity.
     static void FlushCharData(SImplementation *impl) {
         if (!impl->CharDataBuffer.empty()) {
@@ -77,10 +223,7 @@ struct CXMLReader::SImplementation {
             impl->CharDataBuffer.clear();
             
             if (!data.empty()) {
-                SXMLEntity ent;
-                ent.DType = SXMLEntity::EType::CharData;
-                ent.DNameData = data;
-                impl->enQue.push_back(std::move(ent));
+                impl->PushEntity(SXMLEntity::EType::CharData, data.c_str()).DAttributes.clear();
             }
         }
     }
@@ -88,32 +231,56 @@ struct CXMLReader::SImplementation {
     // Callback for start element events.
     static void StartElementHandler(void *userData, const char *name, const char **attrs) {
         auto *impl = static_cast<SImplementation *>(userData);
+        if (impl->SkipDepth || !impl->ElementAllowed(name)) {
+            impl->SkipDepth++;
+            return;
+        }
+        attrs = impl->FilterAttributes(name, attrs);
+        if (impl->DHandler) {
+            Dispatch(impl, [&](SHandler &handler) { handler.StartElement(name, attrs); });
+            return;
+        }
         FlushCharData(impl);
         
-        SXMLEntity ent;
-        ent.DType = SXMLEntity::EType::StartElement;
-        ent.DNameData = name;
-        
-        for (int i = 0; attrs && attrs[i]; i += 2) {
-            ent.SetAttribute(attrs[i], attrs[i + 1]);
+        SXMLEntity &ent = impl->PushEntity(SXMLEntity::EType::StartElement, name);
+        // expat rejects repeated attributes, so they can be assigned in place
+        std::size_t count = 0;
+        while (attrs && attrs[count * 2]) {
+            count++;
+        }
+        ent.DAttributes.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            ent.DAttributes[i].first.assign(attrs[i * 2]);
+            ent.DAttributes[i].second.assign(attrs[i * 2 + 1]);
         }
-        impl->enQue.push_back(std::move(ent));
     }
 
     // Callback for end element events.
     static void EndElementHandler(void *userData, const char *name) {
         auto *impl = static_cast<SImplementation *>(userData);
+        if (impl->SkipDepth) {
+            impl->SkipDepth--;
+            return;
+        }
+        if (impl->DHandler) {
+            Dispatch(impl, [&](SHandler &handler) { handler.EndElement(name); });
+            return;
+        }
         FlushCharData(impl);
         
-        SXMLEntity ent;
-        ent.DType = SXMLEntity::EType::EndElement;
-        ent.DNameData = name;
-        impl->enQue.push_back(std::move(ent));
+        impl->PushEntity(SXMLEntity::EType::EndElement, name).DAttributes.clear();
     }
 
     // Callback for character data events.
     static void CharDataHandler(void *userData, const char *text, int len) {
         auto *impl = static_cast<SImplementation *>(userData);
+        if (impl->SkipDepth) {
+            return;
+        }
+        if (impl->DHandler) {
+            Dispatch(impl, [&](SHandler &handler) { handler.CharData(text, static_cast<std::size_t>(len)); });
+            return;
+        }
         impl->CharDataBuffer.append(text, len);
     }
 };
@@ -129,4 +296,22 @@ bool CXMLReader::End() const {
 
 bool CXMLReader::ReadEntity(SXMLEntity &entity, bool skipdata) {
     return DImplementation->ReadEntity(entity, skipdata);
-}
\ No newline at end of file
+}
+
+bool CXMLReader::Parse(SHandler &handler) {
+    return DImplementation->Parse(handler);
+}
+
+void CXMLReader::AllowElements(const std::vector<std::string> &names) {
+    DImplementation->AllowedElements = names;
+}
+
+void CXMLReader::AllowAttributes(const std::string &element, const std::vector<std::string> &attributes) {
+    for (auto &Filter : DImplementation->AttributeFilters) {
+        if (Filter.DElement == element) {
+            Filter.DAttributes = attributes;
+            return;
+        }
+    }
+    DImplementation->AttributeFilters.push_back({element, attributes});
+}
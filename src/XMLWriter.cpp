@@ -22,8 +22,7 @@ struct CXMLWriter::SImplementation {
         : dsink(std::move(sink)) {}
 
     bool WriteRaw(const std::string &data) {
-        std::vector<char> buffer(data.begin(), data.end());
-        return dsink->Write(buffer);
+        return dsink->Write(data.data(), data.size());
     }
 
     static std::string EscapeXML(const std::string &input) {
@@ -159,7 +158,7 @@ struct CXMLWriter::SImplementation {
                 return false;
             }
         }
-        return true;
+        return dsink->Flush();
     }
 };
 
@@ -1,6 +1,8 @@
 #include "OpenStreetMap.h"
+#include "PBFStreetMap.h"
 #include "BusSystem.h"
 #include "DSVReader.h"
+#include "DSVTableReader.h"
 #include "DSVWriter.h"
 #include "FileDataFactory.h"
 #include "FileDataSource.h"
@@ -13,6 +15,7 @@
 #include <iostream>
 #include <unordered_set>
 #include <unordered_map>
+#include <charconv>
 
 class CArgumentParser{
     private:
@@ -56,6 +59,7 @@ class CKMLTranslator{
 int main(int argc, char *argv[]){
     std::vector<std::string> Arguments;
     const std::string OSMFilename = "city.osm";
+    const std::string PBFFilename = "city.osm.pbf";
     const std::string StopFilename = "stops.csv";
     const std::string BusPathFilename = "buspaths.csv";
 
@@ -75,8 +79,17 @@ int main(int argc, char *argv[]){
     auto StdErr = std::make_shared<CStandardErrorDataSink>();
     auto StopReader = std::make_shared<CDSVReader>(DataFactory->CreateSource(StopFilename),',');
     auto BusPathReader = std::make_shared<CDSVReader>(DataFactory->CreateSource(BusPathFilename),',');
-    auto XMLReader = std::make_shared<CXMLReader>(DataFactory->CreateSource(OSMFilename));
-    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    // Prefer the PBF extract when the data directory has one
+    std::shared_ptr<CStreetMap> StreetMap;
+    auto PBFSource = DataFactory->CreateSource(PBFFilename);
+    char TempCh;
+    if(PBFSource && PBFSource->Peek(TempCh)){
+        StreetMap = std::make_shared<CPBFStreetMap>(PBFSource);
+    }
+    else{
+        auto XMLReader = std::make_shared<CXMLReader>(DataFactory->CreateSource(OSMFilename));
+        StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    }
     CKMLTranslator KMLTranslator(StreetMap,StopReader,BusPathReader);
 
     for(auto &Filename : Parser.Filenames()){
@@ -148,59 +161,50 @@ CKMLTranslator::CKMLTranslator(std::shared_ptr<CStreetMap> map, std::shared_ptr<
         auto Node = map->NodeByIndex(Index);
         DNodeIDToLocation[Node->ID()] = Node->Location();
     }
-    std::vector<std::string> TempRow;
-    if(stops->ReadRow(TempRow)){
-        auto StopIDIndex = TempRow.size();
-        auto NodeIDIndex = StopIDIndex;
-        for(size_t Index = 0; Index < TempRow.size(); Index++){
-            if(TempRow[Index] == StopIDHeading){
-                StopIDIndex = Index;
-            }
-            else if(TempRow[Index] == NodeIDHeading){
-                NodeIDIndex = Index;
-            }
-        }
-        if((StopIDIndex >= TempRow.size())||(NodeIDIndex >= TempRow.size())){
+    CDSVTableReader StopTable(stops);
+    auto StopIDIndex = StopTable.ColumnIndex(StopIDHeading);
+    auto NodeIDIndex = StopTable.ColumnIndex(NodeIDHeading);
+    if(!StopTable.Headings().empty()){
+        if((StopIDIndex == CDSVTableReader::InvalidColumn)||(NodeIDIndex == CDSVTableReader::InvalidColumn)){
             throw std::runtime_error("Missing stops header!");
         }
-        while(stops->ReadRow(TempRow)){
-            auto StopID = std::stoull(TempRow[StopIDIndex]);
-            auto NodeID = std::stoull(TempRow[NodeIDIndex]);
-            DNodeIDToStopID[NodeID] = StopID;
-        }
-    }
-    if(buspaths->ReadRow(TempRow)){
-        auto SourceIDIndex = TempRow.size();
-        auto DestinationIDIndex = SourceIDIndex;
-        auto RoutesIndex = SourceIDIndex;
-        auto PathIndex = SourceIDIndex;
-        for(size_t Index = 0; Index < TempRow.size(); Index++){
-            if(TempRow[Index] == SourceIDHeading){
-                SourceIDIndex = Index;
-            }
-            else if(TempRow[Index] == DestinationIDHeading){
-                DestinationIDIndex = Index;
-            }
-            else if(TempRow[Index] == RoutesHeading){
-                RoutesIndex = Index;
-            }
-            else if(TempRow[Index] == PathHeading){
-                PathIndex = Index;
+        while(StopTable.ReadRow()){
+            CBusSystem::TStopID StopID;
+            CStreetMap::TNodeID NodeID;
+            if(StopTable.Unsigned(StopIDIndex,StopID) && StopTable.Unsigned(NodeIDIndex,NodeID)){
+                DNodeIDToStopID[NodeID] = StopID;
             }
         }
-        if((SourceIDIndex >= TempRow.size())||(DestinationIDIndex >= TempRow.size())||(RoutesIndex >= TempRow.size())||(PathIndex >= TempRow.size())){
+    }
+    buspaths->EnableParallel();
+    CDSVTableReader BusPathTable(buspaths);
+    auto SourceIDIndex = BusPathTable.ColumnIndex(SourceIDHeading);
+    auto DestinationIDIndex = BusPathTable.ColumnIndex(DestinationIDHeading);
+    auto RoutesIndex = BusPathTable.ColumnIndex(RoutesHeading);
+    auto PathIndex = BusPathTable.ColumnIndex(PathHeading);
+    if(!BusPathTable.Headings().empty()){
+        if((SourceIDIndex == CDSVTableReader::InvalidColumn)||(DestinationIDIndex == CDSVTableReader::InvalidColumn)||(RoutesIndex == CDSVTableReader::InvalidColumn)||(PathIndex == CDSVTableReader::InvalidColumn)){
             throw std::runtime_error("Missing buspath header!");
         }
-        while(buspaths->ReadRow(TempRow)){
-            auto SourceID = std::stoull(TempRow[SourceIDIndex]);
-            auto DestinationID = std::stoull(TempRow[DestinationIDIndex]);
-            auto Routes = StringUtils::Split(TempRow[RoutesIndex],"_");
-            auto PathStrings = StringUtils::Split(TempRow[PathIndex],",");
+        while(BusPathTable.ReadRow()){
+            CStreetMap::TNodeID SourceID, DestinationID;
+            std::string_view Path;
+            if(!BusPathTable.Unsigned(SourceIDIndex,SourceID) || !BusPathTable.Unsigned(DestinationIDIndex,DestinationID) || !BusPathTable.Cell(PathIndex,Path)){
+                continue;
+            }
+            // Path is a comma separated list of node IDs
             std::vector<CStreetMap::TLocation> LocationList;
-            for(auto &NodeIDString : PathStrings){
-                auto NodeID = std::stoull(NodeIDString);
+            const char *Current = Path.data();
+            const char *End = Path.data() + Path.size();
+            while(Current < End){
+                CStreetMap::TNodeID NodeID;
+                auto Result = std::from_chars(Current,End,NodeID);
+                if(Result.ec != std::errc()){
+                    break;
+                }
                 auto Node = map->NodeByID(NodeID);
                 LocationList.push_back(Node->Location());
+                Current = Result.ptr < End ? Result.ptr + 1 : End;
             }
             DBusSegmentToLocations[std::make_pair(SourceID,DestinationID)] = LocationList;
         }
@@ -287,28 +291,19 @@ std::vector<std::pair<std::string,CStreetMap::TNodeID> > CKMLTranslator::ParsePa
     const std::string ModeHeading = "mode";
     const std::string NodeIDHeading = "node_id";
     
-    std::vector<std::string> TempRow;
-    if(path->ReadRow(TempRow)){
-        auto ModeIndex = TempRow.size();
-        auto NodeIDIndex = ModeIndex;
-        for(size_t Index = 0; Index < TempRow.size(); Index++){
-            if(TempRow[Index] == ModeHeading){
-                ModeIndex = Index;
-            }
-            else if(TempRow[Index] == NodeIDHeading){
-                NodeIDIndex = Index;
-            }
-        }
-        if((ModeIndex >= TempRow.size())||(NodeIDIndex >= TempRow.size())){
-            return {};
-        }
-        std::vector<std::pair<std::string,CStreetMap::TNodeID> > ReturnVector;
-        while(path->ReadRow(TempRow)){
-            auto Mode = TempRow[ModeIndex];
-            auto NodeID = std::stoull(TempRow[NodeIDIndex]);
-            ReturnVector.push_back(std::make_pair(Mode,NodeID));
+    CDSVTableReader PathTable(path);
+    auto ModeIndex = PathTable.ColumnIndex(ModeHeading);
+    auto NodeIDIndex = PathTable.ColumnIndex(NodeIDHeading);
+    if((ModeIndex == CDSVTableReader::InvalidColumn)||(NodeIDIndex == CDSVTableReader::InvalidColumn)){
+        return {};
+    }
+    std::vector<std::pair<std::string,CStreetMap::TNodeID> > ReturnVector;
+    while(PathTable.ReadRow()){
+        std::string_view Mode;
+        CStreetMap::TNodeID NodeID;
+        if(PathTable.Cell(ModeIndex,Mode) && PathTable.Unsigned(NodeIDIndex,NodeID)){
+            ReturnVector.push_back(std::make_pair(std::string(Mode),NodeID));
         }
-        return ReturnVector;
     }
-    return {};
-}
\ No newline at end of file
+    return ReturnVector;
+}
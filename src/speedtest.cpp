@@ -1,6 +1,7 @@
 #include "TransportationPlannerConfig.h"
 #include "DijkstraTransportationPlanner.h"
 #include "OpenStreetMap.h"
+#include "PBFStreetMap.h"
 #include "CSVBusSystem.h"
 #include "FileDataFactory.h"
 #include "StandardDataSource.h"
@@ -18,10 +19,12 @@ class CArgumentParser{
     private:
         std::string DDataDirectory;
         std::string DResultsDirectory;
+        std::string DSnapshotFilename;
         uint64_t DNumPoints;
         uint64_t DSeed;
         bool DArgumentsValid;
         bool DVerbose;
+        bool DContract;
         
         void PrintSyntax() const;
     public:
@@ -31,7 +34,9 @@ class CArgumentParser{
 
         std::string DataDirectory() const;
         std::string ResultsDirectory() const;
+        std::string SnapshotFilename() const;
         bool Verbose() const;
+        bool Contract() const;
         uint64_t NumPoints() const;
         uint64_t Seed() const;
 };
@@ -58,7 +63,7 @@ class CSpeedTest{
         void NotifyString(const std::string &str);
         void WriteStringToSink(std::shared_ptr<CDataSink> sink, const std::string &str);
     public:
-        CSpeedTest(std::shared_ptr<CDataSink> out, std::shared_ptr<CDataSink> notify, std::shared_ptr<CTransportationPlanner::SConfiguration> config);
+        CSpeedTest(std::shared_ptr<CDataSink> out, std::shared_ptr<CDataSink> notify, std::shared_ptr<CTransportationPlanner::SConfiguration> config, std::shared_ptr<CDijkstraTransportationPlanner> snapshotplanner, uint64_t snapshotloadms, const std::string &snapshot, const std::vector< std::string > &inputs);
 
         bool RunTest(uint64_t seed, uint64_t numpoints, bool verbose);
         bool OutputResults(std::shared_ptr<CDataFactory> results, bool verbose);
@@ -67,6 +72,7 @@ class CSpeedTest{
 int main(int argc, char *argv[]){
     std::vector<std::string> Arguments;
     const std::string OSMFilename = "city.osm";
+    const std::string PBFFilename = "city.osm.pbf";
     const std::string StopFilename = "stops.csv";
     const std::string RouteFilename = "routes.csv";
 
@@ -84,14 +90,38 @@ int main(int argc, char *argv[]){
     auto StdIn = std::make_shared<CStandardDataSource>();
     auto StdOut = std::make_shared<CStandardDataSink>();
     auto StdErr = std::make_shared<CStandardErrorDataSink>();
-    auto StopReader = std::make_shared<CDSVReader>(DataFactory->CreateSource(StopFilename),',');
-    auto RouteReader = std::make_shared<CDSVReader>(DataFactory->CreateSource(RouteFilename),',');
-    auto BusSystem = std::make_shared<CCSVBusSystem>(StopReader, RouteReader);
-    auto XMLReader = std::make_shared<CXMLReader>(DataFactory->CreateSource(OSMFilename));
-    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
-    auto PlannerConfig = std::make_shared<STransportationPlannerConfig>(StreetMap, BusSystem);
+    auto PlannerConfig = std::make_shared<STransportationPlannerConfig>(nullptr, nullptr);
+    PlannerConfig->DContractGraphs = Parser.Contract();
+    // The street map and bus system are only loaded if there is no usable
+    // snapshot, one written from the same, unchanged data files
+    std::string DataPath = Parser.DataDirectory().empty() || Parser.DataDirectory().back() == '/' ? Parser.DataDirectory() : Parser.DataDirectory() + "/";
+    std::vector< std::string > InputFilenames;
+    for(auto &Filename : {PBFFilename, OSMFilename, StopFilename, RouteFilename}){
+        InputFilenames.push_back(DataPath + Filename);
+    }
+    std::shared_ptr<CDijkstraTransportationPlanner> SnapshotPlanner;
+    auto SnapshotStart = std::chrono::steady_clock::now();
+    if(!Parser.SnapshotFilename().empty()){
+        SnapshotPlanner = CDijkstraTransportationPlanner::LoadSnapshot(Parser.SnapshotFilename(), PlannerConfig, InputFilenames);
+    }
+    auto SnapshotDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-SnapshotStart);
+    if(!SnapshotPlanner){
+        auto StopReader = std::make_shared<CDSVReader>(DataFactory->CreateSource(StopFilename),',');
+        auto RouteReader = std::make_shared<CDSVReader>(DataFactory->CreateSource(RouteFilename),',');
+        PlannerConfig->DBusSystem = std::make_shared<CCSVBusSystem>(StopReader, RouteReader);
+        // Prefer the PBF extract when the data directory has one
+        auto PBFSource = DataFactory->CreateSource(PBFFilename);
+        char TempCh;
+        if(PBFSource && PBFSource->Peek(TempCh)){
+            PlannerConfig->DStreetMap = std::make_shared<CPBFStreetMap>(PBFSource);
+        }
+        else{
+            auto XMLReader = std::make_shared<CXMLReader>(DataFactory->CreateSource(OSMFilename));
+            PlannerConfig->DStreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+        }
+    }
 
-    CSpeedTest SpeedTester(StdOut,StdErr,PlannerConfig);
+    CSpeedTest SpeedTester(StdOut,StdErr,PlannerConfig,SnapshotPlanner,SnapshotDuration.count(),Parser.SnapshotFilename(),InputFilenames);
 
     if(SpeedTester.RunTest(Parser.Seed(),Parser.NumPoints(),Parser.Verbose())){
         if(SpeedTester.OutputResults(ResultsFactory,Parser.Verbose())){
@@ -109,6 +139,7 @@ CArgumentParser::CArgumentParser(const std::vector<std::string> &args){
     DNumPoints = 0;
     DSeed = 0;
     DVerbose = false;
+    DContract = false;
     for(auto &Argument : args){
         if(Argument.find("--data") == 0){
             auto SplitArg = StringUtils::Split(Argument,"=");
@@ -126,6 +157,14 @@ CArgumentParser::CArgumentParser(const std::vector<std::string> &args){
             }
             DResultsDirectory = SplitArg[1];
         }
+        else if(Argument.find("--snapshot") == 0){
+            auto SplitArg = StringUtils::Split(Argument,"=");
+            if(SplitArg.size() != 2 || SplitArg[0] != "--snapshot"){
+                DArgumentsValid = false;
+                break;
+            }
+            DSnapshotFilename = SplitArg[1];
+        }
         else if(Argument.find("--seed") == 0){
             auto SplitArg = StringUtils::Split(Argument,"=");
             if(SplitArg.size() != 2 || SplitArg[0] != "--seed"){
@@ -137,6 +176,9 @@ CArgumentParser::CArgumentParser(const std::vector<std::string> &args){
         else if(Argument == "--verbose"){
             DVerbose = true;
         }
+        else if(Argument == "--contract"){
+            DContract = true;
+        }
         else{
             if(DNumPoints){
                 DArgumentsValid = false;
@@ -159,7 +201,7 @@ CArgumentParser::CArgumentParser(const std::vector<std::string> &args){
 }
 
 void CArgumentParser::PrintSyntax() const{
-    std::cerr<<"Syntax Error: speedtest [--data=path | --results=path | --seed=rngseed | --verbose] [numpoints]"<<std::endl;
+    std::cerr<<"Syntax Error: speedtest [--data=path | --results=path | --snapshot=file | --seed=rngseed | --verbose | --contract] [numpoints]"<<std::endl;
 }
 
 bool CArgumentParser::ArgumentsValid() const{
@@ -174,10 +216,18 @@ std::string CArgumentParser::ResultsDirectory() const{
     return DResultsDirectory;
 }
 
+std::string CArgumentParser::SnapshotFilename() const{
+    return DSnapshotFilename;
+}
+
 bool CArgumentParser::Verbose() const{
     return DVerbose;
 }
 
+bool CArgumentParser::Contract() const{
+    return DContract;
+}
+
 uint64_t CArgumentParser::NumPoints() const{
     return DNumPoints;
 }
@@ -186,20 +236,30 @@ uint64_t CArgumentParser::Seed() const{
     return DSeed;
 }
 
-CSpeedTest::CSpeedTest(std::shared_ptr<CDataSink> out, std::shared_ptr<CDataSink> notify, std::shared_ptr<CTransportationPlanner::SConfiguration> config){
+CSpeedTest::CSpeedTest(std::shared_ptr<CDataSink> out, std::shared_ptr<CDataSink> notify, std::shared_ptr<CTransportationPlanner::SConfiguration> config, std::shared_ptr<CDijkstraTransportationPlanner> snapshotplanner, uint64_t snapshotloadms, const std::string &snapshot, const std::vector< std::string > &inputs){
     const int MillisecondsPerSecond = 1000;
     DOutput = out;
     DNotify = notify;
     NotifyString("Loading\n");
-    auto LoadStart = std::chrono::steady_clock::now();
-    DPlanner = std::make_shared<CDijkstraTransportationPlanner>(config);
-    auto LoadDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-LoadStart);
+    // A planner loaded from the snapshot is used as is, its load time counts
+    // as the precompute time; otherwise it is built and the snapshot written
+    std::shared_ptr<CDijkstraTransportationPlanner> Planner = snapshotplanner;
+    uint64_t LoadDuration = snapshotloadms;
+    if(!Planner){
+        auto LoadStart = std::chrono::steady_clock::now();
+        Planner = std::make_shared<CDijkstraTransportationPlanner>(config);
+        LoadDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-LoadStart).count();
+        if(!snapshot.empty() && !Planner->WriteSnapshot(snapshot, inputs)){
+            NotifyString("Failed to write snapshot\n");
+        }
+    }
+    DPlanner = Planner;
     NotifyString("Loaded\n");
-    DViolatedPrecomputeTime = config->PrecomputeTime() * MillisecondsPerSecond < LoadDuration.count();
+    DViolatedPrecomputeTime = config->PrecomputeTime() * MillisecondsPerSecond < LoadDuration;
     if(DViolatedPrecomputeTime){
         NotifyString("Violated precompute time!!!\n");
     }
-    DLoadDurationCount = LoadDuration.count();
+    DLoadDurationCount = LoadDuration;
 }
 
 std::string CSpeedTest::DistanceToString(double dist){
@@ -292,6 +352,9 @@ bool CSpeedTest::RunTest(uint64_t seed, uint64_t numpoints, bool verbose){
     std::vector< CStreetMap::TNodeID > TempShortestPath;
     std::vector< CTransportationPlanner::TTripStep > TempFastestPath;
     std::vector< std::pair< CStreetMap::TNodeID , CStreetMap::TNodeID > > RandomNodePairs;
+    if(!DPlanner){
+        return false;
+    }
     srand(seed);
     NotifyString("Generating src/dest pairs\n");
     for(uint64_t Index = 0; Index < numpoints; Index++){
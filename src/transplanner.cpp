@@ -1,4 +1,5 @@
 #include "OpenStreetMap.h"
+#include "PBFStreetMap.h"
 #include "CSVBusSystem.h"
 #include "TransportationPlannerConfig.h"
 #include "DijkstraTransportationPlanner.h"
@@ -6,24 +7,27 @@
 #include "FileDataFactory.h"
 #include "StandardDataSource.h"
 #include "StandardDataSink.h"
+#include "BufferedDataSink.h"
 #include "StandardErrorDataSink.h"
 #include "DSVReader.h"
 #include "XMLReader.h"
 #include <iostream>
 #include <string>
+#include <vector>
 #include <memory>
 #include <unordered_map>
 
 void PrintUsage(const std::string& programName) {
-    std::cerr << "Usage: " << programName << " street_map.osm stops.csv routes.csv" << std::endl;
-    std::cerr << "  street_map.osm: OpenStreetMap XML file with street map data" << std::endl;
+    std::cerr << "Usage: " << programName << " street_map.osm stops.csv routes.csv [snapshot.bin]" << std::endl;
+    std::cerr << "  street_map.osm: OpenStreetMap XML file with street map data, or PBF if it ends in .pbf" << std::endl;
     std::cerr << "  stops.csv: CSV file with bus stop data" << std::endl;
     std::cerr << "  routes.csv: CSV file with bus route data" << std::endl;
+    std::cerr << "  snapshot.bin: planner snapshot, loaded if usable otherwise written" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     // Check command line arguments
-    if (argc != 4) {
+    if (argc != 4 && argc != 5) {
         PrintUsage(argv[0]);
         return 1;
     }
@@ -31,31 +35,12 @@ int main(int argc, char* argv[]) {
     std::string osmFilename = argv[1];
     std::string stopsFilename = argv[2];
     std::string routesFilename = argv[3];
+    std::string snapshotFilename = argc == 5 ? argv[4] : "";
 
     try {
         // Create the file data factory for input/output
         auto fileFactory = std::make_shared<CFileDataFactory>("./");
         
-        // Load the street map
-        auto osmSource = fileFactory->CreateSource(osmFilename);
-        if (!osmSource) {
-            std::cerr << "Failed to open OSM file: " << osmFilename << std::endl;
-            return 1;
-        }
-        auto xmlReader = std::make_shared<CXMLReader>(osmSource);
-        auto streetMap = std::make_shared<COpenStreetMap>(xmlReader);
-        
-        // Load the bus system data
-        auto stopsSource = fileFactory->CreateSource(stopsFilename);
-        auto routesSource = fileFactory->CreateSource(routesFilename);
-        if (!stopsSource || !routesSource) {
-            std::cerr << "Failed to open bus data files" << std::endl;
-            return 1;
-        }
-        auto stopsReader = std::make_shared<CDSVReader>(stopsSource, ',');
-        auto routesReader = std::make_shared<CDSVReader>(routesSource, ',');
-        auto busSystem = std::make_shared<CCSVBusSystem>(stopsReader, routesReader);
-        
         // Create transportation planner configuration
         // Default values:
         // - Walk speed: 3.0 mph
@@ -63,14 +48,51 @@ int main(int argc, char* argv[]) {
         // - Default speed limit: 25.0 mph
         // - Bus stop time: 30.0 seconds (0.0083 hours)
         // - Precompute time: 30 seconds
-        auto config = std::make_shared<STransportationPlannerConfig>(streetMap, busSystem);
-        
-        // Create transportation planner
-        auto planner = std::make_shared<CDijkstraTransportationPlanner>(config);
+        auto config = std::make_shared<STransportationPlannerConfig>(nullptr, nullptr);
+
+        // A usable snapshot skips parsing the street map and bus system,
+        // unless any of their files changed since it was written
+        const std::vector<std::string> inputFilenames = {osmFilename, stopsFilename, routesFilename};
+        std::shared_ptr<CDijkstraTransportationPlanner> planner;
+        if (!snapshotFilename.empty()) {
+            planner = CDijkstraTransportationPlanner::LoadSnapshot(snapshotFilename, config, inputFilenames);
+        }
+        if (!planner) {
+            // Load the street map
+            auto osmSource = fileFactory->CreateSource(osmFilename);
+            if (!osmSource) {
+                std::cerr << "Failed to open OSM file: " << osmFilename << std::endl;
+                return 1;
+            }
+            const std::string pbfExtension = ".pbf";
+            if (osmFilename.size() > pbfExtension.size() && osmFilename.compare(osmFilename.size() - pbfExtension.size(), pbfExtension.size(), pbfExtension) == 0) {
+                config->DStreetMap = std::make_shared<CPBFStreetMap>(osmSource);
+            } else {
+                auto xmlReader = std::make_shared<CXMLReader>(osmSource);
+                config->DStreetMap = std::make_shared<COpenStreetMap>(xmlReader);
+            }
+
+            // Load the bus system data
+            auto stopsSource = fileFactory->CreateSource(stopsFilename);
+            auto routesSource = fileFactory->CreateSource(routesFilename);
+            if (!stopsSource || !routesSource) {
+                std::cerr << "Failed to open bus data files" << std::endl;
+                return 1;
+            }
+            auto stopsReader = std::make_shared<CDSVReader>(stopsSource, ',');
+            auto routesReader = std::make_shared<CDSVReader>(routesSource, ',');
+            config->DBusSystem = std::make_shared<CCSVBusSystem>(stopsReader, routesReader);
+
+            // Create transportation planner
+            planner = std::make_shared<CDijkstraTransportationPlanner>(config);
+            if (!snapshotFilename.empty() && !planner->WriteSnapshot(snapshotFilename, inputFilenames)) {
+                std::cerr << "Failed to write snapshot: " << snapshotFilename << std::endl;
+            }
+        }
         
         // Create I/O for command line
         auto cmdSource = std::make_shared<CStandardDataSource>();
-        auto outSink = std::make_shared<CStandardDataSink>();
+        auto outSink = std::make_shared<CBufferedDataSink>(std::make_shared<CStandardDataSink>());
         auto errSink = std::make_shared<CStandardErrorDataSink>();
         
         // Create command line interface
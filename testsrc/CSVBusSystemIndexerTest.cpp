@@ -80,5 +80,16 @@ TEST(CSVBusSystemIndexer, RouteTest){
     EXPECT_EQ(Routes.size(),2);
     EXPECT_TRUE(Routes.find(Route1Index) != Routes.end());
     EXPECT_TRUE(Routes.find(Route2Index) != Routes.end());
-
+    EXPECT_TRUE(BusSystemIndexer.RouteBetweenNodeIDs(102,101));
+    EXPECT_FALSE(BusSystemIndexer.RouteBetweenNodeIDs(101,101));
+    EXPECT_FALSE(BusSystemIndexer.RoutesByNodeIDs(101,103,Routes));
+    EXPECT_TRUE(Routes.empty());
+    std::vector< std::pair< std::shared_ptr<CBusSystem::SRoute>, std::size_t > > Positions;
+    EXPECT_TRUE(BusSystemIndexer.RoutePositionsByStopID(1,Positions));
+    ASSERT_EQ(Positions.size(),3);
+    EXPECT_EQ(Positions[0],std::make_pair(Route1Index,std::size_t(1)));
+    EXPECT_EQ(Positions[1],std::make_pair(Route2Index,std::size_t(0)));
+    EXPECT_EQ(Positions[2],std::make_pair(Route2Index,std::size_t(2)));
+    EXPECT_FALSE(BusSystemIndexer.RoutePositionsByStopID(3,Positions));
+    EXPECT_TRUE(Positions.empty());
 }
\ No newline at end of file
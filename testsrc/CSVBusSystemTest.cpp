@@ -61,4 +61,40 @@ TEST(CSVBusSystem, RouteTest){
     EXPECT_EQ(Route1Index->GetStopID(0),1);
     EXPECT_EQ(Route1Index->GetStopID(1),2);
     EXPECT_EQ(Route1Index->GetStopID(2),1);
-}
\ No newline at end of file
+}
+TEST(CSVBusSystem, HeaderOrderTest){
+    auto InStreamStops = std::make_shared<CStringDataSource>(   "node_id,stop_id\n"
+                                                                "101,1\n"
+                                                                "bad,2\n"
+                                                                "103,3");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>(  "stop_id,route\n"
+                                                                "1,A\n"
+                                                                "3,A");
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    CCSVBusSystem BusSystem(CSVReaderStops, CSVReaderRoutes);
+    EXPECT_EQ(BusSystem.StopCount(),2);
+    ASSERT_TRUE(bool(BusSystem.StopByID(3)));
+    EXPECT_EQ(BusSystem.StopByID(3)->NodeID(),103);
+    EXPECT_EQ(BusSystem.StopByID(2),nullptr);
+    ASSERT_TRUE(bool(BusSystem.RouteByName("A")));
+    EXPECT_EQ(BusSystem.RouteByName("A")->StopCount(),2);
+    EXPECT_EQ(BusSystem.RouteByName("A")->GetStopID(1),3);
+}
+
+TEST(CSVBusSystem, NoHeaderTest){
+    // Tables without heading rows keep their first row as data
+    auto InStreamStops = std::make_shared<CStringDataSource>(   "1,101\n"
+                                                                "2,102");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>(  "A,1\n"
+                                                                "A,2");
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    CCSVBusSystem BusSystem(CSVReaderStops, CSVReaderRoutes);
+    EXPECT_EQ(BusSystem.StopCount(),2);
+    ASSERT_TRUE(bool(BusSystem.StopByID(1)));
+    EXPECT_EQ(BusSystem.StopByID(1)->NodeID(),101);
+    ASSERT_TRUE(bool(BusSystem.RouteByName("A")));
+    EXPECT_EQ(BusSystem.RouteByName("A")->StopCount(),2);
+    EXPECT_EQ(BusSystem.RouteByName("A")->GetStopID(0),1);
+}
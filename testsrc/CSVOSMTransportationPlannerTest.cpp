@@ -7,6 +7,9 @@
 #include "TransportationPlannerConfig.h"
 #include "DijkstraTransportationPlanner.h"
 #include "GeographicUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
 
 TEST(CSVOSMTransporationPlanner, SimpleTest){
     auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
@@ -110,6 +113,142 @@ TEST(CSVOSMTransporationPlanner, ShortestPathTest){
     EXPECT_EQ(ShortestPath,ExpectedShortestPath);
 }
 
+TEST(CSVOSMTransporationPlanner, AStarShortestPathTest){
+    auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
+                                                            "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                            "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>"
+                                                            "<node id=\"2\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                            "<node id=\"3\" lat=\"38.6\" lon=\"-121.8\"/>"
+                                                            "<node id=\"4\" lat=\"38.5\" lon=\"-121.8\"/>"
+                                                            "<node id=\"5\" lat=\"38.4\" lon=\"-121.7\"/>"
+                                                            "<way id=\"10\">"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<nd ref=\"2\"/>"
+                                                            "<nd ref=\"3\"/>"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<tag k=\"maxspeed\" v=\"45\"/>"
+                                                            "</way>"
+                                                            "<way id=\"11\">"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<nd ref=\"5\"/>"
+                                                            "<nd ref=\"1\"/>"
+                                                            "</way>"
+                                                            "</osm>");
+    auto InStreamStops = std::make_shared<CStringDataSource>("stop_id,node_id");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>("route,stop_id");
+    auto XMLReader = std::make_shared<CXMLReader>(InStreamOSM);
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    auto BusSystem = std::make_shared<CCSVBusSystem>(CSVReaderStops, CSVReaderRoutes);
+    auto DijkstraConfig = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem);
+    auto AStarConfig = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,30.0,30,CTransportationPlanner::ESearchAlgorithm::AStar);
+    CDijkstraTransportationPlanner DijkstraPlanner(DijkstraConfig);
+    CDijkstraTransportationPlanner AStarPlanner(AStarConfig);
+    for(CTransportationPlanner::TNodeID Src = 1; Src <= 5; Src++){
+        for(CTransportationPlanner::TNodeID Dest = 1; Dest <= 5; Dest++){
+            std::vector< CTransportationPlanner::TNodeID > DijkstraPath, AStarPath;
+            EXPECT_EQ(AStarPlanner.FindShortestPath(Src,Dest,AStarPath),DijkstraPlanner.FindShortestPath(Src,Dest,DijkstraPath));
+            EXPECT_EQ(AStarPath,DijkstraPath);
+        }
+    }
+    std::vector< CTransportationPlanner::TNodeID > Path;
+    EXPECT_EQ(AStarPlanner.FindShortestPath(1,6,Path),CPathRouter::NoPathExists);
+}
+
+TEST(CSVOSMTransporationPlanner, ALTPathTest){
+    auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
+                                                            "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                            "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>"
+                                                            "<node id=\"2\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                            "<node id=\"3\" lat=\"38.6\" lon=\"-121.8\"/>"
+                                                            "<node id=\"4\" lat=\"38.5\" lon=\"-121.8\"/>"
+                                                            "<node id=\"5\" lat=\"38.4\" lon=\"-121.7\"/>"
+                                                            "<node id=\"6\" lat=\"38.7\" lon=\"-121.7\"/>"
+                                                            "<way id=\"10\">"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<nd ref=\"2\"/>"
+                                                            "<nd ref=\"3\"/>"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<tag k=\"oneway\" v=\"yes\"/>"
+                                                            "</way>"
+                                                            "<way id=\"11\">"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<nd ref=\"5\"/>"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<tag k=\"bicycle\" v=\"no\"/>"
+                                                            "</way>"
+                                                            "</osm>");
+    auto InStreamStops = std::make_shared<CStringDataSource>("stop_id,node_id\n"
+                                                            "101,1\n"
+                                                            "102,3");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>("route,stop_id\n"
+                                                             "A,101\n"
+                                                             "A,102");
+    auto XMLReader = std::make_shared<CXMLReader>(InStreamOSM);
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    auto BusSystem = std::make_shared<CCSVBusSystem>(CSVReaderStops, CSVReaderRoutes);
+    auto DijkstraConfig = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem);
+    auto ALTConfig = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,30.0,30,CTransportationPlanner::ESearchAlgorithm::ALT);
+    CDijkstraTransportationPlanner DijkstraPlanner(DijkstraConfig);
+    CDijkstraTransportationPlanner ALTPlanner(ALTConfig);
+    for(CTransportationPlanner::TNodeID Src = 1; Src <= 6; Src++){
+        for(CTransportationPlanner::TNodeID Dest = 1; Dest <= 6; Dest++){
+            std::vector< CTransportationPlanner::TNodeID > DijkstraPath, ALTPath;
+            EXPECT_EQ(ALTPlanner.FindShortestPath(Src,Dest,ALTPath),DijkstraPlanner.FindShortestPath(Src,Dest,DijkstraPath));
+            EXPECT_EQ(ALTPath,DijkstraPath);
+            std::vector< CTransportationPlanner::TTripStep > DijkstraTrip, ALTTrip;
+            EXPECT_EQ(ALTPlanner.FindFastestPath(Src,Dest,ALTTrip),DijkstraPlanner.FindFastestPath(Src,Dest,DijkstraTrip));
+            EXPECT_EQ(ALTTrip,DijkstraTrip);
+        }
+    }
+}
+
+TEST(CSVOSMTransporationPlanner, BidirectionalShortestPathTest){
+    auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
+                                                            "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                            "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>"
+                                                            "<node id=\"2\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                            "<node id=\"3\" lat=\"38.6\" lon=\"-121.8\"/>"
+                                                            "<node id=\"4\" lat=\"38.5\" lon=\"-121.8\"/>"
+                                                            "<node id=\"5\" lat=\"38.4\" lon=\"-121.7\"/>"
+                                                            "<way id=\"10\">"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<nd ref=\"2\"/>"
+                                                            "<nd ref=\"3\"/>"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<tag k=\"maxspeed\" v=\"45\"/>"
+                                                            "</way>"
+                                                            "<way id=\"11\">"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<nd ref=\"5\"/>"
+                                                            "<nd ref=\"1\"/>"
+                                                            "</way>"
+                                                            "</osm>");
+    auto InStreamStops = std::make_shared<CStringDataSource>("stop_id,node_id");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>("route,stop_id");
+    auto XMLReader = std::make_shared<CXMLReader>(InStreamOSM);
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    auto BusSystem = std::make_shared<CCSVBusSystem>(CSVReaderStops, CSVReaderRoutes);
+    auto DijkstraConfig = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem);
+    auto BidirectionalConfig = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,30.0,30,CTransportationPlanner::ESearchAlgorithm::Bidirectional);
+    CDijkstraTransportationPlanner DijkstraPlanner(DijkstraConfig);
+    CDijkstraTransportationPlanner BidirectionalPlanner(BidirectionalConfig);
+    for(CTransportationPlanner::TNodeID Src = 1; Src <= 5; Src++){
+        for(CTransportationPlanner::TNodeID Dest = 1; Dest <= 5; Dest++){
+            std::vector< CTransportationPlanner::TNodeID > DijkstraPath, BidirectionalPath;
+            EXPECT_EQ(BidirectionalPlanner.FindShortestPath(Src,Dest,BidirectionalPath),DijkstraPlanner.FindShortestPath(Src,Dest,DijkstraPath));
+            EXPECT_EQ(BidirectionalPath,DijkstraPath);
+        }
+    }
+    std::vector< CTransportationPlanner::TNodeID > Path;
+    EXPECT_EQ(BidirectionalPlanner.FindShortestPath(1,6,Path),CPathRouter::NoPathExists);
+}
+
 TEST(CSVOSMTransporationPlanner, FastestPathTest){
     auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
                                                             "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
@@ -174,6 +313,268 @@ TEST(CSVOSMTransporationPlanner, FastestPathTest){
 
 }
 
+TEST(CSVOSMTransporationPlanner, BusRideTest){
+    auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
+                                                            "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                            "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>"
+                                                            "<node id=\"2\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                            "<node id=\"3\" lat=\"38.6\" lon=\"-121.8\"/>"
+                                                            "<way id=\"10\">"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<nd ref=\"2\"/>"
+                                                            "<nd ref=\"3\"/>"
+                                                            "<tag k=\"bicycle\" v=\"no\"/>"
+                                                            "</way>"
+                                                            "</osm>");
+    // Stops are listed in a different order than the route visits them
+    auto InStreamStops = std::make_shared<CStringDataSource>("stop_id,node_id\n"
+                                                            "103,3\n"
+                                                            "101,1\n"
+                                                            "102,2");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>("route,stop_id\n"
+                                                             "A,101\n"
+                                                             "A,102\n"
+                                                             "A,103");
+    auto XMLReader = std::make_shared<CXMLReader>(InStreamOSM);
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    auto BusSystem = std::make_shared<CCSVBusSystem>(CSVReaderStops, CSVReaderRoutes);
+    auto Config = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,0.01);
+    CDijkstraTransportationPlanner Planner(Config);
+    double Distance12 = SGeographicUtils::HaversineDistanceInMiles(std::make_pair(38.5,-121.7),std::make_pair(38.6,-121.7));
+    double Distance23 = SGeographicUtils::HaversineDistanceInMiles(std::make_pair(38.6,-121.7),std::make_pair(38.6,-121.8));
+    std::vector< CTransportationPlanner::TTripStep > FastestPath, ExpectedFastestPath = {{CTransportationPlanner::ETransportationMode::Walk,1},
+                                                                                    {CTransportationPlanner::ETransportationMode::Bus,3}};
+    EXPECT_EQ(Planner.FindFastestPath(1,3,FastestPath),0.01 + (Distance12 + Distance23) / 25.0);
+    EXPECT_EQ(FastestPath,ExpectedFastestPath);
+    ExpectedFastestPath = {{CTransportationPlanner::ETransportationMode::Walk,2},
+                            {CTransportationPlanner::ETransportationMode::Bus,3}};
+    EXPECT_EQ(Planner.FindFastestPath(2,3,FastestPath),0.01 + Distance23 / 25.0);
+    EXPECT_EQ(FastestPath,ExpectedFastestPath);
+    // The route only runs one way, going back means walking
+    ExpectedFastestPath = {{CTransportationPlanner::ETransportationMode::Walk,3},
+                            {CTransportationPlanner::ETransportationMode::Walk,2},
+                            {CTransportationPlanner::ETransportationMode::Walk,1}};
+    EXPECT_EQ(Planner.FindFastestPath(3,1,FastestPath),Distance23 / 3.0 + Distance12 / 3.0);
+    EXPECT_EQ(FastestPath,ExpectedFastestPath);
+}
+
+TEST(CSVOSMTransporationPlanner, BusTransferTest){
+    auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
+                                                            "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                            "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>"
+                                                            "<node id=\"2\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                            "<node id=\"3\" lat=\"38.61\" lon=\"-121.7\"/>"
+                                                            "<node id=\"4\" lat=\"38.71\" lon=\"-121.7\"/>"
+                                                            "<way id=\"10\">"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<nd ref=\"2\"/>"
+                                                            "<nd ref=\"3\"/>"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<tag k=\"bicycle\" v=\"no\"/>"
+                                                            "</way>"
+                                                            "</osm>");
+    auto InStreamStops = std::make_shared<CStringDataSource>("stop_id,node_id\n"
+                                                            "101,1\n"
+                                                            "102,2\n"
+                                                            "103,3\n"
+                                                            "104,4");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>("route,stop_id\n"
+                                                             "A,101\n"
+                                                             "A,102\n"
+                                                             "B,103\n"
+                                                             "B,104");
+    auto XMLReader = std::make_shared<CXMLReader>(InStreamOSM);
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    auto BusSystem = std::make_shared<CCSVBusSystem>(CSVReaderStops, CSVReaderRoutes);
+    auto Config = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,0.01);
+    CDijkstraTransportationPlanner Planner(Config);
+    double Distance12 = SGeographicUtils::HaversineDistanceInMiles(std::make_pair(38.5,-121.7),std::make_pair(38.6,-121.7));
+    double Distance23 = SGeographicUtils::HaversineDistanceInMiles(std::make_pair(38.6,-121.7),std::make_pair(38.61,-121.7));
+    double Distance34 = SGeographicUtils::HaversineDistanceInMiles(std::make_pair(38.61,-121.7),std::make_pair(38.71,-121.7));
+    // Two rides with a walking transfer in between
+    std::vector< CTransportationPlanner::TTripStep > FastestPath, ExpectedFastestPath = {{CTransportationPlanner::ETransportationMode::Walk,1},
+                                                                                    {CTransportationPlanner::ETransportationMode::Bus,2},
+                                                                                    {CTransportationPlanner::ETransportationMode::Walk,3},
+                                                                                    {CTransportationPlanner::ETransportationMode::Bus,4}};
+    EXPECT_EQ(Planner.FindFastestPath(1,4,FastestPath),(0.01 + Distance12 / 25.0) + Distance23 / 3.0 + (0.01 + Distance34 / 25.0));
+    EXPECT_EQ(FastestPath,ExpectedFastestPath);
+}
+
+TEST(CSVOSMTransporationPlanner, SnapshotTest){
+    auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
+                                                            "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                            "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>"
+                                                            "<node id=\"2\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                            "<node id=\"3\" lat=\"38.61\" lon=\"-121.7\"/>"
+                                                            "<node id=\"4\" lat=\"38.71\" lon=\"-121.7\"/>"
+                                                            "<node id=\"5\" lat=\"38.71\" lon=\"-121.8\"/>"
+                                                            "<way id=\"10\">"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<nd ref=\"2\"/>"
+                                                            "<nd ref=\"3\"/>"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<tag k=\"oneway\" v=\"yes\"/>"
+                                                            "</way>"
+                                                            "<way id=\"11\">"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<nd ref=\"5\"/>"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<tag k=\"bicycle\" v=\"no\"/>"
+                                                            "</way>"
+                                                            "</osm>");
+    auto InStreamStops = std::make_shared<CStringDataSource>("stop_id,node_id\n"
+                                                            "101,1\n"
+                                                            "102,2\n"
+                                                            "103,3\n"
+                                                            "104,4");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>("route,stop_id\n"
+                                                             "A,101\n"
+                                                             "A,102\n"
+                                                             "B,103\n"
+                                                             "B,104");
+    auto XMLReader = std::make_shared<CXMLReader>(InStreamOSM);
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    auto BusSystem = std::make_shared<CCSVBusSystem>(CSVReaderStops, CSVReaderRoutes);
+    auto Config = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,0.01,30,CTransportationPlanner::ESearchAlgorithm::ALT);
+    CDijkstraTransportationPlanner Planner(Config);
+    std::filesystem::create_directories("./testtmp");
+    const std::string Filename = "./testtmp/planner.snapshot";
+    ASSERT_TRUE(Planner.WriteSnapshot(Filename));
+
+    // The snapshot is usable without the street map or bus system
+    auto SnapshotConfig = std::make_shared<STransportationPlannerConfig>(nullptr,nullptr,3.0,8.0,25.0,0.01,30,CTransportationPlanner::ESearchAlgorithm::ALT);
+    EXPECT_TRUE(CDijkstraTransportationPlanner::SnapshotMatches(Filename,SnapshotConfig));
+    auto SnapshotPlanner = CDijkstraTransportationPlanner::LoadSnapshot(Filename,SnapshotConfig);
+    ASSERT_TRUE(bool(SnapshotPlanner));
+    ASSERT_EQ(SnapshotPlanner->NodeCount(),Planner.NodeCount());
+    for(std::size_t Index = 0; Index < Planner.NodeCount(); Index++){
+        EXPECT_EQ(SnapshotPlanner->SortedNodeByIndex(Index)->ID(),Planner.SortedNodeByIndex(Index)->ID());
+        EXPECT_EQ(SnapshotPlanner->SortedNodeByIndex(Index)->Location(),Planner.SortedNodeByIndex(Index)->Location());
+    }
+    for(CTransportationPlanner::TNodeID Src = 1; Src <= 5; Src++){
+        for(CTransportationPlanner::TNodeID Dest = 1; Dest <= 5; Dest++){
+            std::vector< CTransportationPlanner::TNodeID > Path, SnapshotPath;
+            EXPECT_EQ(SnapshotPlanner->FindShortestPath(Src,Dest,SnapshotPath),Planner.FindShortestPath(Src,Dest,Path));
+            EXPECT_EQ(SnapshotPath,Path);
+            std::vector< CTransportationPlanner::TTripStep > Trip, SnapshotTrip;
+            EXPECT_EQ(SnapshotPlanner->FindFastestPath(Src,Dest,SnapshotTrip),Planner.FindFastestPath(Src,Dest,Trip));
+            EXPECT_EQ(SnapshotTrip,Trip);
+        }
+    }
+
+    // Different configuration values, missing and truncated files are rejected
+    auto OtherConfig = std::make_shared<STransportationPlannerConfig>(nullptr,nullptr,3.5,8.0,25.0,0.01,30,CTransportationPlanner::ESearchAlgorithm::ALT);
+    EXPECT_FALSE(CDijkstraTransportationPlanner::SnapshotMatches(Filename,OtherConfig));
+    EXPECT_FALSE(bool(CDijkstraTransportationPlanner::LoadSnapshot(Filename,OtherConfig)));
+    EXPECT_FALSE(bool(CDijkstraTransportationPlanner::LoadSnapshot("./testtmp/missing.snapshot",SnapshotConfig)));
+    std::filesystem::resize_file(Filename,std::filesystem::file_size(Filename) - 8);
+    EXPECT_FALSE(bool(CDijkstraTransportationPlanner::LoadSnapshot(Filename,SnapshotConfig)));
+
+    // Snapshots of changed, missing or different input files are rejected
+    const std::string InputFilename = "./testtmp/planner.input";
+    std::ofstream(InputFilename) << "stop_id,node_id\n";
+    ASSERT_TRUE(Planner.WriteSnapshot(Filename,{InputFilename}));
+    EXPECT_TRUE(CDijkstraTransportationPlanner::SnapshotMatches(Filename,SnapshotConfig,{InputFilename}));
+    EXPECT_TRUE(bool(CDijkstraTransportationPlanner::LoadSnapshot(Filename,SnapshotConfig,{InputFilename})));
+    EXPECT_FALSE(CDijkstraTransportationPlanner::SnapshotMatches(Filename,SnapshotConfig));
+    EXPECT_FALSE(CDijkstraTransportationPlanner::SnapshotMatches(Filename,SnapshotConfig,{"./testtmp/missing.input"}));
+    std::ofstream(InputFilename, std::ios::app) << "101,1\n";
+    EXPECT_FALSE(CDijkstraTransportationPlanner::SnapshotMatches(Filename,SnapshotConfig,{InputFilename}));
+    EXPECT_FALSE(bool(CDijkstraTransportationPlanner::LoadSnapshot(Filename,SnapshotConfig,{InputFilename})));
+    std::remove(InputFilename.c_str());
+    std::remove(Filename.c_str());
+}
+
+TEST(CSVOSMTransporationPlanner, ContractedGraphTest){
+    // Nodes 2, 3, 5 and 7 are shape points, 6 is kept for its bus stop and
+    // 9 is in no way
+    auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
+                                                            "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                            "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>"
+                                                            "<node id=\"2\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                            "<node id=\"3\" lat=\"38.61\" lon=\"-121.7\"/>"
+                                                            "<node id=\"4\" lat=\"38.71\" lon=\"-121.7\"/>"
+                                                            "<node id=\"5\" lat=\"38.71\" lon=\"-121.8\"/>"
+                                                            "<node id=\"6\" lat=\"38.6\" lon=\"-121.8\"/>"
+                                                            "<node id=\"7\" lat=\"38.72\" lon=\"-121.6\"/>"
+                                                            "<node id=\"8\" lat=\"38.73\" lon=\"-121.6\"/>"
+                                                            "<node id=\"9\" lat=\"38.8\" lon=\"-121.6\"/>"
+                                                            "<way id=\"10\">"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<nd ref=\"2\"/>"
+                                                            "<nd ref=\"3\"/>"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<tag k=\"oneway\" v=\"yes\"/>"
+                                                            "</way>"
+                                                            "<way id=\"11\">"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<nd ref=\"5\"/>"
+                                                            "<nd ref=\"6\"/>"
+                                                            "<nd ref=\"1\"/>"
+                                                            "<tag k=\"bicycle\" v=\"no\"/>"
+                                                            "</way>"
+                                                            "<way id=\"12\">"
+                                                            "<nd ref=\"4\"/>"
+                                                            "<nd ref=\"7\"/>"
+                                                            "<nd ref=\"8\"/>"
+                                                            "</way>"
+                                                            "</osm>");
+    auto InStreamStops = std::make_shared<CStringDataSource>("stop_id,node_id\n"
+                                                            "101,6\n"
+                                                            "102,8");
+    auto InStreamRoutes = std::make_shared<CStringDataSource>("route,stop_id\n"
+                                                             "A,101\n"
+                                                             "A,102");
+    auto XMLReader = std::make_shared<CXMLReader>(InStreamOSM);
+    auto CSVReaderStops = std::make_shared<CDSVReader>(InStreamStops,',');
+    auto CSVReaderRoutes = std::make_shared<CDSVReader>(InStreamRoutes,',');
+    auto StreetMap = std::make_shared<COpenStreetMap>(XMLReader);
+    auto BusSystem = std::make_shared<CCSVBusSystem>(CSVReaderStops, CSVReaderRoutes);
+    std::filesystem::create_directories("./testtmp");
+    const std::string Filename = "./testtmp/contracted.snapshot";
+    // Contracting the graphs changes neither costs nor paths
+    for(auto Algorithm : {CTransportationPlanner::ESearchAlgorithm::Dijkstra, CTransportationPlanner::ESearchAlgorithm::AStar,
+                          CTransportationPlanner::ESearchAlgorithm::ALT, CTransportationPlanner::ESearchAlgorithm::Bidirectional}){
+        auto Config = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,0.01,30,Algorithm);
+        auto ContractedConfig = std::make_shared<STransportationPlannerConfig>(StreetMap,BusSystem,3.0,8.0,25.0,0.01,30,Algorithm,true);
+        CDijkstraTransportationPlanner Planner(Config);
+        CDijkstraTransportationPlanner ContractedPlanner(ContractedConfig);
+        ASSERT_TRUE(ContractedPlanner.WriteSnapshot(Filename));
+        EXPECT_FALSE(CDijkstraTransportationPlanner::SnapshotMatches(Filename,Config));
+        auto SnapshotConfig = std::make_shared<STransportationPlannerConfig>(nullptr,nullptr,3.0,8.0,25.0,0.01,30,Algorithm,true);
+        auto SnapshotPlanner = CDijkstraTransportationPlanner::LoadSnapshot(Filename,SnapshotConfig);
+        ASSERT_TRUE(bool(SnapshotPlanner));
+        ASSERT_EQ(ContractedPlanner.NodeCount(),Planner.NodeCount());
+        for(CTransportationPlanner::TNodeID Src = 1; Src <= 9; Src++){
+            for(CTransportationPlanner::TNodeID Dest = 1; Dest <= 9; Dest++){
+                std::vector< CTransportationPlanner::TNodeID > Path, ContractedPath, SnapshotPath;
+                double Distance = Planner.FindShortestPath(Src,Dest,Path);
+                EXPECT_EQ(ContractedPlanner.FindShortestPath(Src,Dest,ContractedPath),Distance);
+                EXPECT_EQ(SnapshotPlanner->FindShortestPath(Src,Dest,SnapshotPath),Distance);
+                if(Distance != CPathRouter::NoPathExists){
+                    EXPECT_EQ(ContractedPath,Path);
+                    EXPECT_EQ(SnapshotPath,Path);
+                }
+                std::vector< CTransportationPlanner::TTripStep > Trip, ContractedTrip, SnapshotTrip;
+                double Time = Planner.FindFastestPath(Src,Dest,Trip);
+                EXPECT_EQ(ContractedPlanner.FindFastestPath(Src,Dest,ContractedTrip),Time);
+                EXPECT_EQ(SnapshotPlanner->FindFastestPath(Src,Dest,SnapshotTrip),Time);
+                if(Time != CPathRouter::NoPathExists){
+                    EXPECT_EQ(ContractedTrip,Trip);
+                    EXPECT_EQ(SnapshotTrip,Trip);
+                }
+            }
+        }
+    }
+    std::remove(Filename.c_str());
+}
+
 TEST(CSVOSMTransporationPlanner, PathDescription){
     auto InStreamOSM = std::make_shared<CStringDataSource>( "<?xml version='1.0' encoding='UTF-8'?>"
                                                             "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
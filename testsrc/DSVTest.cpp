@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "DSVReader.h"
 #include "DSVWriter.h"
+#include "DSVTableReader.h"
 #include "StringUtils.h"
 #include "StringDataSource.h"
 #include "StringDataSink.h"
@@ -104,4 +105,224 @@ TEST(DSVReader, QuotingTest){
     EXPECT_EQ(StringVector[0],"1,000");
     EXPECT_EQ(StringVector[1],"My name is \"Bob\"!");
     EXPECT_EQ(StringVector[2],"3.3");    
-}
\ No newline at end of file
+}
+
+TEST(DSVReader, SourcePositionTest){
+    auto DSVSource = std::make_shared<CStringDataSource>("a,b\r\nc,d\n");
+    CDSVReader DSVReader(DSVSource,',');
+    std::vector<std::string> StringVector;
+    char TempCh;
+
+    EXPECT_TRUE(DSVReader.ReadRow(StringVector));
+    EXPECT_EQ(StringVector,std::vector<std::string>({"a","b"}));
+    EXPECT_TRUE(DSVSource->Peek(TempCh));
+    EXPECT_EQ(TempCh,'c');
+    EXPECT_TRUE(DSVReader.ReadRow(StringVector));
+    EXPECT_EQ(StringVector,std::vector<std::string>({"c","d"}));
+    EXPECT_TRUE(DSVReader.End());
+    EXPECT_TRUE(DSVSource->End());
+}
+
+// Source lending its data in regions of a fixed size
+class CRegionDataSource : public CDataSource{
+    private:
+        std::string DString;
+        std::size_t DIndex;
+        std::size_t DRegionSize;
+    public:
+        CRegionDataSource(const std::string &str, std::size_t regionsize) : DString(str), DIndex(0), DRegionSize(regionsize){
+        }
+
+        bool End() const noexcept override{
+            return DIndex >= DString.size();
+        }
+
+        bool Get(char &ch) noexcept override{
+            if(!Peek(ch)){
+                return false;
+            }
+            DIndex++;
+            return true;
+        }
+
+        bool Peek(char &ch) noexcept override{
+            if(End()){
+                return false;
+            }
+            ch = DString[DIndex];
+            return true;
+        }
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            buf.clear();
+            char TempCh;
+            while(count-- && Get(TempCh)){
+                buf.push_back(TempCh);
+            }
+            return !buf.empty();
+        }
+
+        bool Borrow(const char *&data, std::size_t &size) noexcept override{
+            if(End()){
+                return false;
+            }
+            data = DString.data() + DIndex;
+            size = std::min(DRegionSize, DString.size() - DIndex);
+            return true;
+        }
+
+        void Consume(std::size_t count) noexcept override{
+            DIndex = std::min(DString.size(), DIndex + count);
+        }
+};
+
+TEST(DSVReader, RegionBoundaryTest){
+    // Rows split across regions leave the source at the end of the row, even
+    // when a line ending or quote needs a character of lookahead
+    const std::string Input = "a,b\rc,\"d\"\"e\"\r\nf,\"g\"\nh";
+    const std::vector<std::vector<std::string>> Expected = {{"a","b"},{"c","d\"e"},{"f","g"},{"h"}};
+    const std::vector<char> NextChars = {'c','f','h'};
+    for(std::size_t RegionSize = 1; RegionSize <= Input.size(); RegionSize++){
+        auto DSVSource = std::make_shared<CRegionDataSource>(Input,RegionSize);
+        CDSVReader DSVReader(DSVSource,',');
+        std::vector<std::string> StringVector;
+        char TempCh;
+
+        for(std::size_t Index = 0; Index < Expected.size(); Index++){
+            ASSERT_TRUE(DSVReader.ReadRow(StringVector)) << RegionSize;
+            EXPECT_EQ(StringVector,Expected[Index]) << RegionSize;
+            if(Index < NextChars.size()){
+                EXPECT_TRUE(DSVSource->Peek(TempCh));
+                EXPECT_EQ(TempCh,NextChars[Index]) << RegionSize;
+            }
+        }
+        EXPECT_TRUE(DSVReader.End());
+        EXPECT_FALSE(DSVReader.ReadRow(StringVector));
+    }
+}
+
+TEST(DSVReader, LargeRegionTest){
+    // Regions consumed whole that are not the last one are served a row at
+    // a time, gathering the row that runs past each of them
+    std::string Input;
+    for(int Index = 0; Index < 5000; Index++){
+        Input += std::to_string(Index) + ",\"x\"\r\n";
+    }
+    CDSVReader DSVReader(std::make_shared<CRegionDataSource>(Input,10007),',');
+    DSVReader.EnableParallel(1000,2);
+    std::vector<std::string> StringVector;
+
+    for(int Index = 0; Index < 5000; Index++){
+        ASSERT_TRUE(DSVReader.ReadRow(StringVector));
+        EXPECT_EQ(StringVector,std::vector<std::string>({std::to_string(Index),"x"}));
+    }
+    EXPECT_FALSE(DSVReader.ReadRow(StringVector));
+    EXPECT_TRUE(DSVReader.End());
+}
+
+TEST(DSVReader, LongFieldTest){
+    std::string Plain(70,'x');
+    std::string Quoted = std::string(40,'y') + ",\n\"\"" + std::string(33,'z');
+    std::string Expected = std::string(40,'y') + ",\n\"" + std::string(33,'z');
+    auto DSVSource = std::make_shared<CStringDataSource>(Plain + ",\"" + Quoted + "\"," + Plain + "\r\n" + Plain);
+    CDSVReader DSVReader(DSVSource,',');
+    std::vector<std::string> StringVector;
+
+    EXPECT_TRUE(DSVReader.ReadRow(StringVector));
+    EXPECT_EQ(StringVector,std::vector<std::string>({Plain,Expected,Plain}));
+    EXPECT_TRUE(DSVReader.ReadRow(StringVector));
+    EXPECT_EQ(StringVector,std::vector<std::string>({Plain}));
+    EXPECT_TRUE(DSVReader.End());
+}
+
+TEST(DSVReader, RowViewTest){
+    auto DSVSource = std::make_shared<CStringDataSource>("1,\"a,b\",\"say \"\"hi\"\"\"\n,x\n");
+    CDSVReader DSVReader(DSVSource,',');
+    std::vector<std::string_view> ViewVector;
+
+    EXPECT_TRUE(DSVReader.ReadRowView(ViewVector));
+    ASSERT_EQ(ViewVector.size(),3);
+    EXPECT_EQ(ViewVector[0],"1");
+    EXPECT_EQ(ViewVector[1],"a,b");
+    EXPECT_EQ(ViewVector[2],"say \"hi\"");
+    EXPECT_TRUE(DSVReader.ReadRowView(ViewVector));
+    ASSERT_EQ(ViewVector.size(),2);
+    EXPECT_EQ(ViewVector[0],"");
+    EXPECT_EQ(ViewVector[1],"x");
+    EXPECT_TRUE(DSVReader.End());
+    EXPECT_FALSE(DSVReader.ReadRowView(ViewVector));
+}
+
+TEST(DSVTableReader, TypedTest){
+    auto DSVSource = std::make_shared<CStringDataSource>("id,name,speed\n7,\"Main St\",25.5\nx,Side,-\n9\n");
+    CDSVTableReader TableReader(std::make_shared<CDSVReader>(DSVSource,','));
+    uint64_t ID;
+    double Speed;
+    std::string_view Name;
+
+    ASSERT_EQ(TableReader.Headings().size(),3);
+    EXPECT_EQ(TableReader.ColumnIndex("name"),1);
+    EXPECT_EQ(TableReader.ColumnIndex("missing"),CDSVTableReader::InvalidColumn);
+    EXPECT_TRUE(TableReader.ReadRow());
+    EXPECT_TRUE(TableReader.Unsigned(0,ID));
+    EXPECT_EQ(ID,7);
+    EXPECT_TRUE(TableReader.Cell(1,Name));
+    EXPECT_EQ(Name,"Main St");
+    EXPECT_TRUE(TableReader.Double(2,Speed));
+    EXPECT_DOUBLE_EQ(Speed,25.5);
+    EXPECT_EQ(TableReader.ErrorCount(),0);
+    EXPECT_TRUE(TableReader.ReadRow());
+    EXPECT_FALSE(TableReader.Unsigned(0,ID));
+    EXPECT_FALSE(TableReader.Double(2,Speed));
+    EXPECT_EQ(TableReader.ErrorCount(),2);
+    EXPECT_TRUE(TableReader.ReadRow());
+    EXPECT_TRUE(TableReader.Unsigned(0,ID));
+    EXPECT_EQ(ID,9);
+    EXPECT_FALSE(TableReader.Cell(1,Name));
+    EXPECT_EQ(TableReader.ErrorCount(),3);
+    EXPECT_FALSE(TableReader.ReadRow());
+    EXPECT_EQ(TableReader.RowCount(),3);
+}
+
+TEST(DSVTableReader, HeadingsAreDataTest){
+    auto DSVSource = std::make_shared<CStringDataSource>("5,6\n7,8\n");
+    CDSVTableReader TableReader(std::make_shared<CDSVReader>(DSVSource,','));
+    uint64_t Value;
+
+    TableReader.HeadingsAreData();
+    EXPECT_TRUE(TableReader.Headings().empty());
+    EXPECT_FALSE(TableReader.End());
+    EXPECT_TRUE(TableReader.ReadRow());
+    EXPECT_TRUE(TableReader.Unsigned(1,Value));
+    EXPECT_EQ(Value,6);
+    EXPECT_TRUE(TableReader.ReadRow());
+    EXPECT_TRUE(TableReader.Unsigned(0,Value));
+    EXPECT_EQ(Value,7);
+    EXPECT_FALSE(TableReader.ReadRow());
+    EXPECT_EQ(TableReader.RowCount(),2);
+}
+
+TEST(DSVReader, ParallelTest){
+    std::string Input;
+    for(int Index = 0; Index < 20000; Index++){
+        Input += std::to_string(Index) + ",\"quoted\n" + std::to_string(Index) + " \"\"cell\"\"\",plain\r\n";
+    }
+    CDSVReader SerialReader(std::make_shared<CStringDataSource>(Input),',');
+    CDSVReader ParallelReader(std::make_shared<CStringDataSource>(Input),',');
+    ParallelReader.EnableParallel(0,4);
+    std::vector<std::string> SerialRow;
+    std::vector<std::string_view> ParallelRow;
+    std::size_t RowCount = 0;
+
+    while(SerialReader.ReadRow(SerialRow)){
+        ASSERT_TRUE(ParallelReader.ReadRowView(ParallelRow));
+        ASSERT_EQ(ParallelRow.size(),SerialRow.size());
+        for(std::size_t Index = 0; Index < SerialRow.size(); Index++){
+            EXPECT_EQ(ParallelRow[Index],SerialRow[Index]);
+        }
+        RowCount++;
+    }
+    EXPECT_EQ(RowCount,20000);
+    EXPECT_TRUE(ParallelReader.End());
+    EXPECT_FALSE(ParallelReader.ReadRowView(ParallelRow));
+}
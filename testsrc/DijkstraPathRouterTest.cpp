@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "DijkstraPathRouter.h"
+#include <random>
+
+TEST(DijkstraPathRouter, SimpleTest){
+    CDijkstraPathRouter PathRouter;
+    std::vector<CPathRouter::TVertexID> Vertices;
+    for(std::size_t Index = 0; Index < 6; Index++){
+        Vertices.push_back(PathRouter.AddVertex(Index));
+        EXPECT_EQ(Index, std::any_cast<std::size_t>(PathRouter.GetVertexTag(Vertices.back())));
+    }
+    EXPECT_EQ(PathRouter.VertexCount(), 6);
+    PathRouter.AddEdge(Vertices[0],Vertices[4],3);
+    PathRouter.AddEdge(Vertices[4],Vertices[5],90);
+    PathRouter.AddEdge(Vertices[5],Vertices[3],6);
+    PathRouter.AddEdge(Vertices[3],Vertices[2],8);
+    PathRouter.AddEdge(Vertices[2],Vertices[0],1);
+    PathRouter.AddEdge(Vertices[2],Vertices[1],3);
+    PathRouter.AddEdge(Vertices[1],Vertices[3],9);
+    PathRouter.AddEdge(Vertices[4],Vertices[1],1);
+    std::vector<CPathRouter::TVertexID> Route;
+    std::vector<CPathRouter::TVertexID> ExpectedRoute = {Vertices[0], Vertices[4], Vertices[1], Vertices[3]};
+    EXPECT_EQ(13.0, PathRouter.FindShortestPath(Vertices[0], Vertices[3], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+    EXPECT_EQ(CPathRouter::NoPathExists, PathRouter.FindShortestPath(Vertices[0], 6, Route));
+}
+
+TEST(DijkstraPathRouter, PrecomputeTest){
+    CDijkstraPathRouter PathRouter;
+    std::vector<CPathRouter::TVertexID> Vertices;
+    for(std::size_t Index = 0; Index < 6; Index++){
+        Vertices.push_back(PathRouter.AddVertex(Index));
+    }
+    PathRouter.AddEdge(Vertices[0],Vertices[4],3);
+    PathRouter.AddEdge(Vertices[4],Vertices[5],90);
+    PathRouter.AddEdge(Vertices[5],Vertices[3],6);
+    PathRouter.AddEdge(Vertices[3],Vertices[2],8);
+    PathRouter.AddEdge(Vertices[2],Vertices[0],1);
+    PathRouter.AddEdge(Vertices[2],Vertices[1],3);
+    PathRouter.AddEdge(Vertices[1],Vertices[3],9);
+    PathRouter.AddEdge(Vertices[4],Vertices[1],1);
+    EXPECT_TRUE(PathRouter.Precompute(std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+    std::vector<CPathRouter::TVertexID> Route;
+    std::vector<CPathRouter::TVertexID> ExpectedRoute = {Vertices[0], Vertices[4], Vertices[1], Vertices[3]};
+    EXPECT_EQ(13.0, PathRouter.FindShortestPath(Vertices[0], Vertices[3], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+    ExpectedRoute = {Vertices[3], Vertices[2], Vertices[0], Vertices[4], Vertices[5]};
+    EXPECT_EQ(102.0, PathRouter.FindShortestPath(Vertices[3], Vertices[5], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+    ExpectedRoute = {Vertices[2]};
+    EXPECT_EQ(0.0, PathRouter.FindShortestPath(Vertices[2], Vertices[2], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+
+    // Adding an edge discards the hierarchy, results must still be correct
+    PathRouter.AddEdge(Vertices[0],Vertices[3],2);
+    ExpectedRoute = {Vertices[0], Vertices[3]};
+    EXPECT_EQ(2.0, PathRouter.FindShortestPath(Vertices[0], Vertices[3], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+}
+
+TEST(DijkstraPathRouter, PrecomputeDeadlineTest){
+    CDijkstraPathRouter PathRouter;
+    auto Src = PathRouter.AddVertex(std::string("src"));
+    auto Dest = PathRouter.AddVertex(std::string("dest"));
+    PathRouter.AddEdge(Src,Dest,5.0,true);
+    EXPECT_FALSE(PathRouter.Precompute(std::chrono::steady_clock::now() - std::chrono::seconds(1)));
+    std::vector<CPathRouter::TVertexID> Route;
+    std::vector<CPathRouter::TVertexID> ExpectedRoute = {Dest, Src};
+    EXPECT_EQ(5.0, PathRouter.FindShortestPath(Dest, Src, Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+}
+
+TEST(DijkstraPathRouter, PrecomputeRandomGraphTest){
+    CDijkstraPathRouter PlainRouter, HierarchyRouter;
+    const std::size_t VertexCount = 300;
+    std::mt19937 Generator(1234);
+    std::uniform_int_distribution<std::size_t> VertexDistribution(0, VertexCount - 1);
+    std::uniform_int_distribution<int> WeightDistribution(1, 100);
+    for(std::size_t Index = 0; Index < VertexCount; Index++){
+        PlainRouter.AddVertex(Index);
+        HierarchyRouter.AddVertex(Index);
+    }
+    for(std::size_t Index = 0; Index < VertexCount * 3; Index++){
+        auto Src = VertexDistribution(Generator);
+        auto Dest = VertexDistribution(Generator);
+        double Weight = WeightDistribution(Generator) / 10.0;
+        bool Bidirectional = Index % 2;
+        PlainRouter.AddEdge(Src, Dest, Weight, Bidirectional);
+        HierarchyRouter.AddEdge(Src, Dest, Weight, Bidirectional);
+    }
+    EXPECT_TRUE(HierarchyRouter.Precompute(std::chrono::steady_clock::now() + std::chrono::seconds(30)));
+    for(std::size_t Index = 0; Index < 500; Index++){
+        auto Src = VertexDistribution(Generator);
+        auto Dest = VertexDistribution(Generator);
+        std::vector<CPathRouter::TVertexID> PlainRoute, HierarchyRoute;
+        double PlainDistance = PlainRouter.FindShortestPath(Src, Dest, PlainRoute);
+        double HierarchyDistance = HierarchyRouter.FindShortestPath(Src, Dest, HierarchyRoute);
+        EXPECT_DOUBLE_EQ(PlainDistance, HierarchyDistance);
+        if(PlainDistance != CPathRouter::NoPathExists){
+            ASSERT_FALSE(HierarchyRoute.empty());
+            EXPECT_EQ(HierarchyRoute.front(), Src);
+            EXPECT_EQ(HierarchyRoute.back(), Dest);
+        }
+    }
+}
+
+TEST(DijkstraPathRouter, BidirectionalSearchTest){
+    CDijkstraPathRouter PathRouter;
+    std::vector<CPathRouter::TVertexID> Vertices;
+    for(std::size_t Index = 0; Index < 7; Index++){
+        Vertices.push_back(PathRouter.AddVertex(Index));
+    }
+    // One way chain 0 -> 1 -> 2 -> 3 with a cheaper detour 1 -> 4 -> 3
+    PathRouter.AddEdge(Vertices[0],Vertices[1],1.5);
+    PathRouter.AddEdge(Vertices[1],Vertices[2],2.0);
+    PathRouter.AddEdge(Vertices[2],Vertices[3],2.0);
+    PathRouter.AddEdge(Vertices[1],Vertices[4],1.0);
+    PathRouter.AddEdge(Vertices[4],Vertices[3],1.25);
+    PathRouter.AddEdge(Vertices[4],Vertices[3],7.0);
+    PathRouter.AddEdge(Vertices[5],Vertices[6],1.0,true);
+    std::vector<CPathRouter::TVertexID> Route;
+    std::vector<CPathRouter::TVertexID> ExpectedRoute = {Vertices[0], Vertices[1], Vertices[4], Vertices[3]};
+    EXPECT_EQ(3.75, PathRouter.FindShortestPath(Vertices[0], Vertices[3], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+    EXPECT_EQ(CPathRouter::NoPathExists, PathRouter.FindShortestPath(Vertices[3], Vertices[0], Route));
+    EXPECT_EQ(CPathRouter::NoPathExists, PathRouter.FindShortestPath(Vertices[0], Vertices[6], Route));
+    ExpectedRoute = {Vertices[6], Vertices[5]};
+    EXPECT_EQ(1.0, PathRouter.FindShortestPath(Vertices[6], Vertices[5], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+    ExpectedRoute = {Vertices[4]};
+    EXPECT_EQ(0.0, PathRouter.FindShortestPath(Vertices[4], Vertices[4], Route));
+    EXPECT_EQ(Route, ExpectedRoute);
+}
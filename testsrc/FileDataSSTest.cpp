@@ -2,6 +2,7 @@
 #include "FileDataFactory.h"
 #include "FileDataSink.h"
 #include "FileDataSource.h"
+#include "MappedFileDataSource.h"
 #include <cstdio>
 
 // Assume being run from Makefile so testtmp is subdirectory
@@ -55,3 +56,35 @@ TEST(FileDataSourceSink, WriteTest){
     EXPECT_EQ(InBuffer,OutBuffer);
     EXPECT_TRUE(Source->End());
 }
+
+TEST(FileDataSourceSink, MappedSourceTest){
+    CFileDataFactory DataFactory(BaseDirectory);
+    std::string Filename = "mapped.txt";
+    std::remove((BaseDirectory + Filename).c_str());
+    std::vector<char> OutBuffer, InBuffer;
+    for(char Ch = ' '; Ch < '~'; Ch++){
+        OutBuffer.push_back(Ch);
+    }
+    {
+        auto Sink = DataFactory.CreateSink(Filename);
+        EXPECT_TRUE(Sink->Write(OutBuffer));
+    }
+    auto Source = DataFactory.CreateSource(Filename);
+    EXPECT_NE(std::dynamic_pointer_cast<CMappedFileDataSource>(Source),nullptr);
+    char TempCh;
+    EXPECT_TRUE(Source->Peek(TempCh));
+    EXPECT_EQ(TempCh,' ');
+    EXPECT_TRUE(Source->Get(TempCh));
+    EXPECT_EQ(TempCh,' ');
+    EXPECT_TRUE(Source->Read(InBuffer,10));
+    EXPECT_EQ(InBuffer,std::vector<char>(OutBuffer.begin() + 1,OutBuffer.begin() + 11));
+    EXPECT_TRUE(Source->Read(InBuffer,OutBuffer.size()));
+    EXPECT_EQ(InBuffer,std::vector<char>(OutBuffer.begin() + 11,OutBuffer.end()));
+    EXPECT_TRUE(Source->End());
+    EXPECT_FALSE(Source->Get(TempCh));
+    EXPECT_FALSE(Source->Read(InBuffer,1));
+
+    CMappedFileDataSource MissingSource(BaseDirectory + "missing.txt");
+    EXPECT_FALSE(MissingSource.Valid());
+    EXPECT_TRUE(MissingSource.End());
+}
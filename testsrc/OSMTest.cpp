@@ -129,4 +129,157 @@ TEST(OSMTest, WayTest){
     EXPECT_EQ(TempWay->AttributeCount(),1);
     EXPECT_TRUE(TempWay->HasAttribute("oneway"));
     EXPECT_EQ(TempWay->GetAttribute("oneway"),"yes");
-}
\ No newline at end of file
+}
+TEST(OSMTest, RelationTest){
+    auto InStream = std::make_shared<CStringDataSource>("<?xml version='1.0' encoding='UTF-8'?>"
+                                                        "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                        "<bounds minlat=\"38.4\" minlon=\"-121.8\" maxlat=\"38.6\" maxlon=\"-121.6\"/>"
+                                                        "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\" version=\"2\"/>"
+                                                        "<node id=\"2\" lat=\"38.5\" lon=\"-121.71\"/>"
+                                                        "<way id=\"3\" user=\"someone\">"
+                                                        "<nd ref=\"1\"/>"
+                                                        "<nd ref=\"2\"/>"
+                                                        "</way>"
+                                                        "<relation id=\"4\">"
+                                                        "<member type=\"way\" ref=\"3\" role=\"\"/>"
+                                                        "<tag k=\"type\" v=\"route\"/>"
+                                                        "</relation>"
+                                                        "</osm>");
+    auto Reader = std::make_shared<CXMLReader>(InStream);
+    COpenStreetMap StreetMap(Reader);
+    
+    EXPECT_EQ(StreetMap.NodeCount(),2);
+    EXPECT_EQ(StreetMap.WayCount(),1);
+    auto TempWay = StreetMap.WayByID(3);
+    ASSERT_TRUE(bool(TempWay));
+    EXPECT_EQ(TempWay->NodeCount(),2);
+    EXPECT_EQ(TempWay->AttributeCount(),0);
+    EXPECT_EQ(StreetMap.NodeByID(1)->AttributeCount(),0);
+}
+
+TEST(OSMTest, LookupTest){
+    auto InStream = std::make_shared<CStringDataSource>("<?xml version='1.0' encoding='UTF-8'?>"
+                                                        "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                        "<node id=\"30\" lat=\"38.5\" lon=\"-121.7\"><tag k=\"name\" v=\"c\"/></node>"
+                                                        "<node id=\"10\" lat=\"38.6\" lon=\"-121.7\"/>"
+                                                        "<node id=\"20\" lat=\"38.7\" lon=\"-121.7\"><tag k=\"name\" v=\"b\"/></node>"
+                                                        "<way id=\"5\"><nd ref=\"30\"/><nd ref=\"10\"/><nd ref=\"20\"/><tag k=\"oneway\" v=\"yes\"/></way>"
+                                                        "<way id=\"4\"><nd ref=\"20\"/><nd ref=\"10\"/></way>"
+                                                        "</osm>");
+    auto Reader = std::make_shared<CXMLReader>(InStream);
+    std::shared_ptr<CStreetMap::SNode> TempNode;
+    std::shared_ptr<CStreetMap::SWay> TempWay;
+    {
+        COpenStreetMap StreetMap(Reader);
+
+        EXPECT_EQ(StreetMap.NodeCount(),3);
+        EXPECT_EQ(StreetMap.WayCount(),2);
+        EXPECT_EQ(StreetMap.NodeByID(10),StreetMap.NodeByIndex(1));
+        EXPECT_EQ(StreetMap.NodeByID(20),StreetMap.NodeByIndex(2));
+        EXPECT_EQ(StreetMap.NodeByID(30),StreetMap.NodeByIndex(0));
+        EXPECT_EQ(StreetMap.NodeByID(15),nullptr);
+        EXPECT_EQ(StreetMap.NodeByIndex(3),nullptr);
+        EXPECT_EQ(StreetMap.WayByID(4),StreetMap.WayByIndex(1));
+        EXPECT_EQ(StreetMap.WayByID(6),nullptr);
+        TempNode = StreetMap.NodeByID(20);
+        TempWay = StreetMap.WayByID(5);
+    }
+    ASSERT_TRUE(bool(TempNode));
+    EXPECT_EQ(TempNode->Location(),std::make_pair(38.7,-121.7));
+    EXPECT_EQ(TempNode->GetAttribute("name"),"b");
+    EXPECT_EQ(TempNode->GetAttributeKey(0),"name");
+    EXPECT_EQ(TempNode->GetAttributeKey(1),"");
+    ASSERT_TRUE(bool(TempWay));
+    EXPECT_EQ(TempWay->NodeCount(),3);
+    EXPECT_EQ(TempWay->GetNodeID(2),20);
+    EXPECT_EQ(TempWay->GetNodeID(3),std::numeric_limits<CStreetMap::TNodeID>::max());
+    EXPECT_EQ(TempWay->GetAttribute("oneway"),"yes");
+}
+
+TEST(OSMTest, AttributeIDTest){
+    auto InStream = std::make_shared<CStringDataSource>("<?xml version='1.0' encoding='UTF-8'?>"
+                                                        "<osm version=\"0.6\" generator=\"osmconvert 0.8.5\">"
+                                                        "<node id=\"1\" lat=\"38.5\" lon=\"-121.7\"><tag k=\"bicycle\" v=\"yes\"/></node>"
+                                                        "<node id=\"2\" lat=\"38.5\" lon=\"-121.71\"/>"
+                                                        "<way id=\"3\"><nd ref=\"1\"/><nd ref=\"2\"/><tag k=\"oneway\" v=\"yes\"/><tag k=\"bicycle\" v=\"no\"/></way>"
+                                                        "</osm>");
+    auto Reader = std::make_shared<CXMLReader>(InStream);
+    COpenStreetMap StreetMap(Reader);
+    const CStreetMap::TAttributeID Invalid = CStreetMap::InvalidAttributeID;
+
+    auto OnewayID = StreetMap.AttributeID("oneway");
+    auto BicycleID = StreetMap.AttributeID("bicycle");
+    auto YesID = StreetMap.AttributeID("yes");
+    auto NoID = StreetMap.AttributeID("no");
+    EXPECT_NE(OnewayID,Invalid);
+    EXPECT_NE(BicycleID,Invalid);
+    EXPECT_NE(YesID,Invalid);
+    EXPECT_NE(NoID,Invalid);
+    EXPECT_NE(YesID,NoID);
+    EXPECT_EQ(StreetMap.AttributeID("maxspeed"),Invalid);
+
+    auto TempWay = StreetMap.WayByID(3);
+    ASSERT_TRUE(bool(TempWay));
+    EXPECT_EQ(TempWay->GetAttributeID(OnewayID),YesID);
+    EXPECT_EQ(TempWay->GetAttributeID(BicycleID),NoID);
+    EXPECT_EQ(TempWay->GetAttributeID(YesID),Invalid);
+    EXPECT_EQ(TempWay->GetAttributeKey(1),"bicycle");
+    EXPECT_EQ(TempWay->GetAttribute("bicycle"),"no");
+    EXPECT_FALSE(TempWay->HasAttribute("maxspeed"));
+    auto TempNode = StreetMap.NodeByID(1);
+    ASSERT_TRUE(bool(TempNode));
+    EXPECT_EQ(TempNode->GetAttributeID(BicycleID),YesID);
+    EXPECT_EQ(StreetMap.NodeByID(2)->GetAttributeID(BicycleID),Invalid);
+}
+
+TEST(OSMTest, ParallelTest){
+    std::string Input = "<?xml version='1.0' encoding='UTF-8'?><osm version=\"0.6\">";
+    for(int Index = 0; Index < 20000; Index++){
+        Input += "<node id=\"" + std::to_string(Index) + "\" lat=\"38." + std::to_string(Index) + "\" lon=\"-121.7\">";
+        if(Index % 7 == 0){
+            Input += "<tag k=\"name\" v=\"n" + std::to_string(Index % 50) + "\"/>";
+        }
+        Input += "</node>";
+    }
+    for(int Index = 0; Index < 5000; Index++){
+        Input += "<way id=\"" + std::to_string(Index) + "\">";
+        Input += "<nd ref=\"" + std::to_string(Index) + "\"/><tag k=\"oneway\" v=\"yes\"/><nd ref=\"" + std::to_string(Index + 1) + "\"/>";
+        Input += "</way>";
+    }
+    Input += "</osm>";
+    COpenStreetMap SerialMap(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(Input)), 1);
+    COpenStreetMap ParallelMap(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(Input)), 3);
+
+    ASSERT_EQ(SerialMap.NodeCount(),20000);
+    ASSERT_EQ(ParallelMap.NodeCount(),20000);
+    ASSERT_EQ(ParallelMap.WayCount(),5000);
+    for(std::size_t Index = 0; Index < 20000; Index++){
+        auto SerialNode = SerialMap.NodeByIndex(Index);
+        auto ParallelNode = ParallelMap.NodeByIndex(Index);
+        ASSERT_EQ(ParallelNode->ID(),SerialNode->ID());
+        EXPECT_EQ(ParallelNode->Location(),SerialNode->Location());
+        EXPECT_EQ(ParallelNode->AttributeCount(),SerialNode->AttributeCount());
+        EXPECT_EQ(ParallelNode->GetAttribute("name"),SerialNode->GetAttribute("name"));
+        EXPECT_EQ(ParallelMap.NodeByID(Index),ParallelNode);
+    }
+    for(std::size_t Index = 0; Index < 5000; Index++){
+        auto SerialWay = SerialMap.WayByIndex(Index);
+        auto ParallelWay = ParallelMap.WayByIndex(Index);
+        ASSERT_EQ(ParallelWay->ID(),SerialWay->ID());
+        ASSERT_EQ(ParallelWay->NodeCount(),2);
+        EXPECT_EQ(ParallelWay->GetNodeID(0),SerialWay->GetNodeID(0));
+        EXPECT_EQ(ParallelWay->GetNodeID(1),SerialWay->GetNodeID(1));
+        EXPECT_EQ(ParallelWay->GetAttributeID(ParallelMap.AttributeID("oneway")),ParallelMap.AttributeID("yes"));
+    }
+    EXPECT_EQ(ParallelMap.AttributeID("n3"),ParallelMap.NodeByIndex(17703)->GetAttributeID(ParallelMap.AttributeID("name")));
+}
+
+TEST(OSMTest, ParallelErrorTest){
+    std::string Input = "<osm>";
+    for(int Index = 0; Index < 20000; Index++){
+        Input += "<node id=\"" + std::to_string(Index) + "\" lat=\"1\" lon=\"2\"/>";
+    }
+    Input += "<node id=\"bad\" lat=\"1\" lon=\"2\"/></osm>";
+
+    EXPECT_THROW(COpenStreetMap(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(Input)), 3), std::invalid_argument);
+}
@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include "PBFStreetMap.h"
+#include "StringDataSource.h"
+
+// Minimal protobuf encoder for building PBF fixtures in memory
+class CProtoWriter{
+    private:
+        std::string DData;
+
+    public:
+        const std::string &String() const{
+            return DData;
+        }
+
+        void Varint(uint64_t value){
+            while(value >= 0x80){
+                DData.push_back(char((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            DData.push_back(char(value));
+        }
+
+        void Key(uint32_t field, uint32_t wiretype){
+            Varint((uint64_t(field) << 3) | wiretype);
+        }
+
+        void Int(uint32_t field, int64_t value){
+            Key(field, 0);
+            Varint(uint64_t(value));
+        }
+
+        void SInt(uint32_t field, int64_t value){
+            Key(field, 0);
+            Varint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+        }
+
+        void Bytes(uint32_t field, const std::string &value){
+            Key(field, 2);
+            Varint(value.size());
+            DData += value;
+        }
+
+        void Packed(uint32_t field, const std::vector< uint64_t > &values){
+            CProtoWriter Packed;
+            for(auto Value : values){
+                Packed.Varint(Value);
+            }
+            Bytes(field, Packed.String());
+        }
+
+        // Delta codes and zigzag encodes values into a packed field
+        void PackedDelta(uint32_t field, const std::vector< int64_t > &values){
+            std::vector< uint64_t > Encoded;
+            int64_t Last = 0;
+            for(auto Value : values){
+                int64_t Delta = Value - Last;
+                Encoded.push_back((uint64_t(Delta) << 1) ^ uint64_t(Delta >> 63));
+                Last = Value;
+            }
+            Packed(field, Encoded);
+        }
+};
+
+// Frames a blob of the given type, zlib compressing it if requested
+std::string Frame(const std::string &type, const std::string &data, bool compress){
+    CProtoWriter Blob;
+    if(compress){
+        std::string Compressed(compressBound(data.size()), '\0');
+        uLongf Length = Compressed.size();
+        compress2(reinterpret_cast< Bytef * >(&Compressed[0]), &Length, reinterpret_cast< const Bytef * >(data.data()), data.size(), 9);
+        Compressed.resize(Length);
+        Blob.Int(2, data.size());
+        Blob.Bytes(3, Compressed);
+    }
+    else{
+        Blob.Bytes(1, data);
+    }
+    CProtoWriter Header;
+    Header.Bytes(1, type);
+    Header.Int(3, Blob.String().size());
+    uint32_t Size = Header.String().size();
+    std::string Result;
+    Result.push_back(char(Size >> 24));
+    Result.push_back(char(Size >> 16));
+    Result.push_back(char(Size >> 8));
+    Result.push_back(char(Size));
+    return Result + Header.String() + Blob.String();
+}
+
+std::string HeaderBlock(const std::vector< std::string > &features){
+    CProtoWriter Header;
+    for(auto &Feature : features){
+        Header.Bytes(4, Feature);
+    }
+    return Frame("OSMHeader", Header.String(), false);
+}
+
+std::string StringTable(const std::vector< std::string > &strings){
+    CProtoWriter Table;
+    for(auto &String : strings){
+        Table.Bytes(1, String);
+    }
+    return Table.String();
+}
+
+// Three dense nodes and a way, using the default granularity
+std::string DenseBlock(bool compress){
+    CProtoWriter Dense;
+    Dense.PackedDelta(1, {1, 2, 3});
+    Dense.PackedDelta(8, {385000000, 385100000, 385200000});
+    Dense.PackedDelta(9, {-1217000000, -1217100000, -1217200000});
+    // Node 1 has no tags, node 2 has highway=stop, node 3 has two tags
+    Dense.Packed(10, {0, 1, 2, 0, 3, 4, 1, 5, 0});
+
+    CProtoWriter Way;
+    Way.Int(1, 10);
+    Way.Packed(2, {6});
+    Way.Packed(3, {7});
+    Way.PackedDelta(8, {1, 2, 3});
+
+    CProtoWriter Group;
+    Group.Bytes(2, Dense.String());
+    Group.Bytes(3, Way.String());
+
+    CProtoWriter Block;
+    Block.Bytes(1, StringTable({"", "highway", "stop", "name", "Main", "crossing", "oneway", "yes"}));
+    Block.Bytes(2, Group.String());
+    return Frame("OSMData", Block.String(), compress);
+}
+
+// A plain node with a custom granularity and offset, after its group
+std::string PlainBlock(){
+    CProtoWriter Node;
+    Node.SInt(1, 4);
+    Node.Packed(2, {1});
+    Node.Packed(3, {2});
+    Node.SInt(8, 5000);
+    Node.SInt(9, -12000);
+
+    CProtoWriter Relation;
+    Relation.Int(1, 99);
+
+    CProtoWriter Group;
+    Group.Bytes(1, Node.String());
+    Group.Bytes(4, Relation.String());
+
+    CProtoWriter Block;
+    Block.Bytes(2, Group.String());
+    Block.Bytes(1, StringTable({"", "oneway", "no"}));
+    Block.Int(17, 10000);
+    Block.Int(19, 38000000000);
+    Block.Int(20, -121000000000);
+    return Frame("OSMData", Block.String(), false);
+}
+
+std::shared_ptr< CStringDataSource > Source(const std::string &data){
+    return std::make_shared< CStringDataSource >(data);
+}
+
+TEST(PBFStreetMapTest, EmptyTest){
+    CPBFStreetMap StreetMap(Source(""));
+
+    EXPECT_EQ(StreetMap.NodeCount(),0);
+    EXPECT_EQ(StreetMap.WayCount(),0);
+}
+
+TEST(PBFStreetMapTest, DenseNodeTest){
+    for(bool Compress : {false, true}){
+        CPBFStreetMap StreetMap(Source(HeaderBlock({"OsmSchema-V0.6", "DenseNodes"}) + DenseBlock(Compress)), 1);
+
+        ASSERT_EQ(StreetMap.NodeCount(),3);
+        ASSERT_EQ(StreetMap.WayCount(),1);
+        auto TempNode = StreetMap.NodeByIndex(0);
+        EXPECT_EQ(TempNode,StreetMap.NodeByID(1));
+        EXPECT_EQ(TempNode->AttributeCount(),0);
+        EXPECT_DOUBLE_EQ(TempNode->Location().first,38.5);
+        EXPECT_DOUBLE_EQ(TempNode->Location().second,-121.7);
+        TempNode = StreetMap.NodeByID(2);
+        ASSERT_TRUE(bool(TempNode));
+        EXPECT_EQ(TempNode->AttributeCount(),1);
+        EXPECT_EQ(TempNode->GetAttribute("highway"),"stop");
+        EXPECT_DOUBLE_EQ(TempNode->Location().first,38.51);
+        TempNode = StreetMap.NodeByID(3);
+        ASSERT_TRUE(bool(TempNode));
+        EXPECT_EQ(TempNode->AttributeCount(),2);
+        EXPECT_EQ(TempNode->GetAttributeKey(0),"name");
+        EXPECT_EQ(TempNode->GetAttribute("name"),"Main");
+        EXPECT_EQ(TempNode->GetAttribute("highway"),"crossing");
+
+        auto TempWay = StreetMap.WayByID(10);
+        ASSERT_TRUE(bool(TempWay));
+        EXPECT_EQ(TempWay->NodeCount(),3);
+        EXPECT_EQ(TempWay->GetNodeID(0),1);
+        EXPECT_EQ(TempWay->GetNodeID(2),3);
+        EXPECT_EQ(TempWay->GetAttribute("oneway"),"yes");
+        EXPECT_EQ(TempWay->GetAttributeID(StreetMap.AttributeID("oneway")),StreetMap.AttributeID("yes"));
+    }
+}
+
+TEST(PBFStreetMapTest, PlainNodeTest){
+    CPBFStreetMap StreetMap(Source(PlainBlock()), 1);
+
+    ASSERT_EQ(StreetMap.NodeCount(),1);
+    EXPECT_EQ(StreetMap.WayCount(),0);
+    auto TempNode = StreetMap.NodeByID(4);
+    ASSERT_TRUE(bool(TempNode));
+    EXPECT_DOUBLE_EQ(TempNode->Location().first,38.05);
+    EXPECT_DOUBLE_EQ(TempNode->Location().second,-121.12);
+    EXPECT_EQ(TempNode->GetAttribute("oneway"),"no");
+}
+
+TEST(PBFStreetMapTest, ParallelTest){
+    std::string Data = HeaderBlock({"OsmSchema-V0.6"});
+    for(int Index = 0; Index < 8; Index++){
+        Data += Index % 2 ? PlainBlock() : DenseBlock(Index % 4 == 0);
+    }
+    CPBFStreetMap SerialMap(Source(Data), 1);
+    CPBFStreetMap ParallelMap(Source(Data), 3);
+
+    ASSERT_EQ(ParallelMap.NodeCount(),SerialMap.NodeCount());
+    ASSERT_EQ(ParallelMap.WayCount(),SerialMap.WayCount());
+    for(std::size_t Index = 0; Index < 16; Index++){
+        auto SerialNode = SerialMap.NodeByIndex(Index);
+        auto ParallelNode = ParallelMap.NodeByIndex(Index);
+        ASSERT_TRUE(bool(ParallelNode));
+        EXPECT_EQ(ParallelNode->ID(),SerialNode->ID());
+        EXPECT_EQ(ParallelNode->Location(),SerialNode->Location());
+        EXPECT_EQ(ParallelNode->AttributeCount(),SerialNode->AttributeCount());
+        for(std::size_t Attribute = 0; Attribute < SerialNode->AttributeCount(); Attribute++){
+            auto Key = SerialNode->GetAttributeKey(Attribute);
+            EXPECT_EQ(ParallelNode->GetAttributeKey(Attribute),Key);
+            EXPECT_EQ(ParallelNode->GetAttribute(Key),SerialNode->GetAttribute(Key));
+        }
+    }
+    EXPECT_EQ(ParallelMap.WayByIndex(3)->GetAttribute("oneway"),"yes");
+}
+
+TEST(PBFStreetMapTest, ErrorTest){
+    std::string Data = HeaderBlock({"OsmSchema-V0.6"}) + DenseBlock(true);
+
+    EXPECT_THROW(CPBFStreetMap(Source(Data.substr(0, Data.size() - 5)), 1), std::runtime_error);
+    EXPECT_THROW(CPBFStreetMap(Source(HeaderBlock({"HistoricalInformation"})), 1), std::runtime_error);
+
+    CProtoWriter Blob;
+    Blob.Int(2, 10);
+    Blob.Bytes(4, "lzma");
+    CProtoWriter Header;
+    Header.Bytes(1, "OSMData");
+    Header.Int(3, Blob.String().size());
+    std::string Lzma = std::string(3, '\0') + char(Header.String().size()) + Header.String() + Blob.String();
+    EXPECT_THROW(CPBFStreetMap(Source(Lzma), 1), std::runtime_error);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "StringDataSink.h"
+#include "BufferedDataSink.h"
 
 TEST(StringDataSink, EmptyTest){
     CStringDataSink EmptySink;
@@ -30,3 +31,39 @@ TEST(StringDataSink, WriteTest){
     EXPECT_TRUE(Sink.Write(TempVector2));
     EXPECT_EQ(Sink.String(),"Hello World");   
 }
+
+TEST(BufferedDataSink, FlushTest){
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        CBufferedDataSink BufferedSink(Sink,8);
+        std::string Hello = "Hello";
+
+        EXPECT_TRUE(BufferedSink.Put('>'));
+        EXPECT_TRUE(BufferedSink.Write(Hello.data(),Hello.size()));
+        EXPECT_EQ(Sink->String(),"");
+        EXPECT_TRUE(BufferedSink.Flush());
+        EXPECT_EQ(Sink->String(),">Hello");
+        EXPECT_TRUE(BufferedSink.Write(std::vector<char>{' ','W','o','r','l','d'}));
+        EXPECT_EQ(Sink->String(),">Hello");
+    }
+    EXPECT_EQ(Sink->String(),">Hello World");
+}
+
+TEST(BufferedDataSink, CapacityTest){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CBufferedDataSink BufferedSink(Sink,4);
+    std::string Long = "abcdefgh";
+
+    EXPECT_TRUE(BufferedSink.Write("xyz",3));
+    EXPECT_EQ(Sink->String(),"");
+    EXPECT_TRUE(BufferedSink.Write("12",2));
+    EXPECT_EQ(Sink->String(),"xyz");
+    EXPECT_TRUE(BufferedSink.Write(Long.data(),Long.size()));
+    EXPECT_EQ(Sink->String(),"xyz12abcdefgh");
+    for(char Ch : std::string("ijklm")){
+        EXPECT_TRUE(BufferedSink.Put(Ch));
+    }
+    EXPECT_EQ(Sink->String(),"xyz12abcdefghijkl");
+    EXPECT_TRUE(BufferedSink.Flush());
+    EXPECT_EQ(Sink->String(),"xyz12abcdefghijklm");
+}
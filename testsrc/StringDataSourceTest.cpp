@@ -81,3 +81,25 @@ TEST(StringDataSource, ReadTest){
     EXPECT_FALSE(Source2.Peek(TempCh));
     EXPECT_EQ(TempCh,'x');
 }
+
+TEST(StringDataSource, BorrowTest){
+    CStringDataSource EmptySource("");
+    CStringDataSource Source1("Hello");
+    const char *Data = nullptr;
+    std::size_t Size = 0;
+    char TempCh = 'x';
+
+    EXPECT_FALSE(EmptySource.Borrow(Data,Size));
+    EXPECT_TRUE(Source1.Borrow(Data,Size));
+    EXPECT_EQ(std::string(Data,Size),"Hello");
+    EXPECT_TRUE(Source1.Peek(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    Source1.Consume(2);
+    EXPECT_TRUE(Source1.Get(TempCh));
+    EXPECT_EQ(TempCh,'l');
+    EXPECT_TRUE(Source1.Borrow(Data,Size));
+    EXPECT_EQ(std::string(Data,Size),"lo");
+    Source1.Consume(Size);
+    EXPECT_TRUE(Source1.End());
+    EXPECT_FALSE(Source1.Borrow(Data,Size));
+}
@@ -188,10 +188,197 @@ TEST(XMLReaderTest, SpecialCharacterTest){
     EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
     EXPECT_EQ(Entity.DNameData, "elem");
     EXPECT_EQ(Entity.DAttributes.size(), 0);
-    
+
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(XMLReaderTest, ManyEntityTest){
+    std::string Input = "<way id=\"1\">";
+    for(int Index = 0; Index < 2000; Index++){
+        Input += "<nd ref=\"" + std::to_string(Index) + "\"/>";
+        if(Index % 3 == 0){
+            Input += "<tag k=\"a\" v=\"b\"/>";
+        }
+    }
+    Input += "</way>";
+    auto InStream = std::make_shared<CStringDataSource>(Input);
+    CXMLReader Reader(InStream);
+    SXMLEntity Entity;
+
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(Entity.DNameData, "way");
+    for(int Index = 0; Index < 2000; Index++){
+        ASSERT_TRUE(Reader.ReadEntity(Entity));
+        EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+        EXPECT_EQ(Entity.DNameData, "nd");
+        EXPECT_EQ(Entity.DAttributes.size(), 1);
+        EXPECT_EQ(Entity.AttributeValue("ref"), std::to_string(Index));
+        ASSERT_TRUE(Reader.ReadEntity(Entity));
+        EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+        EXPECT_EQ(Entity.DNameData, "nd");
+        EXPECT_EQ(Entity.DAttributes.size(), 0);
+        if(Index % 3 == 0){
+            ASSERT_TRUE(Reader.ReadEntity(Entity));
+            EXPECT_EQ(Entity.DNameData, "tag");
+            EXPECT_EQ(Entity.DAttributes.size(), 2);
+            EXPECT_EQ(Entity.AttributeValue("v"), "b");
+            ASSERT_TRUE(Reader.ReadEntity(Entity));
+            EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+        }
+    }
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entity.DNameData, "way");
+    EXPECT_TRUE(Reader.End());
+}
+
+struct SRecordingHandler : public CXMLReader::SHandler{
+    std::vector< std::string > DEvents;
+
+    void StartElement(const char *name, const char **attrs) override{
+        std::string Event = std::string("+") + name;
+        for(int Index = 0; attrs[Index]; Index += 2){
+            Event += std::string(" ") + attrs[Index] + "=" + attrs[Index + 1];
+        }
+        DEvents.push_back(Event);
+    }
+
+    void EndElement(const char *name) override{
+        DEvents.push_back(std::string("-") + name);
+    }
+
+    void CharData(const char *data, std::size_t length) override{
+        if(!DEvents.empty() && DEvents.back()[0] == '#'){
+            DEvents.back().append(data, length);
+        }
+        else{
+            DEvents.push_back("#" + std::string(data, length));
+        }
+    }
+};
+
+TEST(XMLReaderTest, HandlerTest){
+    auto InStream = std::make_shared<CStringDataSource>("<osm><node id=\"1\" lat=\"2\"><tag k=\"a\" v=\"b\"/></node>text</osm>");
+    CXMLReader Reader(InStream);
+    SRecordingHandler Handler;
+
+    EXPECT_TRUE(Reader.Parse(Handler));
+    EXPECT_EQ(Handler.DEvents, std::vector< std::string >({"+osm", "+node id=1 lat=2", "+tag k=a v=b", "-tag", "-node", "#text", "-osm"}));
+    EXPECT_TRUE(Reader.End());
+    EXPECT_FALSE(Reader.Parse(Handler));
+}
+
+TEST(XMLReaderTest, HandlerAfterReadTest){
+    auto InStream = std::make_shared<CStringDataSource>("<osm><node id=\"1\"/><way id=\"2\"/></osm>");
+    CXMLReader Reader(InStream);
+    SXMLEntity Entity;
+    SRecordingHandler Handler;
+
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DNameData, "osm");
+    EXPECT_TRUE(Reader.Parse(Handler));
+    EXPECT_EQ(Handler.DEvents, std::vector< std::string >({"+node id=1", "-node", "+way id=2", "-way", "-osm"}));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(XMLReaderTest, HandlerExceptionTest){
+    struct SThrowingHandler : public CXMLReader::SHandler{
+        void EndElement(const char *) override{
+            throw std::invalid_argument("stop");
+        }
+    };
+    auto InStream = std::make_shared<CStringDataSource>("<osm><node/></osm>");
+    CXMLReader Reader(InStream);
+    SThrowingHandler Handler;
+
+    EXPECT_THROW(Reader.Parse(Handler), std::invalid_argument);
+}
+
+TEST(XMLReaderTest, FilterTest){
+    auto InStream = std::make_shared<CStringDataSource>("<osm>a<node id=\"1\" user=\"x\"/>"
+                                                        "<relation id=\"2\"><member ref=\"1\"/><node id=\"3\"/>text</relation>"
+                                                        "b<way id=\"4\" version=\"1\"/></osm>");
+    CXMLReader Reader(InStream);
+    SXMLEntity Entity;
+
+    Reader.AllowElements({"osm", "node", "way"});
+    Reader.AllowAttributes("node", {"id"});
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DNameData, "osm");
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::CharData);
+    EXPECT_EQ(Entity.DNameData, "a");
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(Entity.DNameData, "node");
+    EXPECT_EQ(Entity.DAttributes.size(), 1);
+    EXPECT_EQ(Entity.AttributeValue("id"), "1");
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entity.DNameData, "node");
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::CharData);
+    EXPECT_EQ(Entity.DNameData, "b");
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(Entity.DNameData, "way");
+    EXPECT_EQ(Entity.DAttributes.size(), 2);
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entity.DNameData, "way");
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entity.DNameData, "osm");
     EXPECT_TRUE(Reader.End());
 }
 
+// Source using the default one character Borrow, like the stream sources
+class CCharDataSource : public CDataSource{
+    private:
+        CStringDataSource DSource;
+    public:
+        CCharDataSource(const std::string &str) : DSource(str){
+        }
+
+        bool End() const noexcept override{
+            return DSource.End();
+        }
+
+        bool Get(char &ch) noexcept override{
+            return DSource.Get(ch);
+        }
+
+        bool Peek(char &ch) noexcept override{
+            return DSource.Peek(ch);
+        }
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            return DSource.Read(buf, count);
+        }
+};
+
+TEST(XMLReaderTest, CharSourceTest){
+    auto InStream = std::make_shared<CCharDataSource>("<osm><node id=\"1\"/><way id=\"2\"><tag k=\"name\" v=\"Main\"/></way></osm>");
+    CXMLReader Reader(InStream);
+    SXMLEntity Entity;
+    std::vector< std::string > Names;
+
+    while(Reader.ReadEntity(Entity)){
+        Names.push_back((Entity.DType == SXMLEntity::EType::StartElement ? "+" : "-") + Entity.DNameData);
+    }
+    EXPECT_EQ(Names, std::vector< std::string >({"+osm", "+node", "-node", "+way", "+tag", "-tag", "-way", "-osm"}));
+    EXPECT_TRUE(Reader.End());
+
+    // A document that ends with a self-closing element
+    InStream = std::make_shared<CCharDataSource>("<node id=\"1\" lat=\"2\"/>");
+    CXMLReader SingleReader(InStream);
+    SRecordingHandler Handler;
+    EXPECT_TRUE(SingleReader.Parse(Handler));
+    EXPECT_EQ(Handler.DEvents, std::vector< std::string >({"+node id=1 lat=2", "-node"}));
+    EXPECT_TRUE(SingleReader.End());
+}
+
 TEST(XMLWriterTest, SimpleTest){
     auto OutStream = std::make_shared<CStringDataSink>();
     CXMLWriter Writer(OutStream);